@@ -0,0 +1,337 @@
+#include "Config.hpp"
+#include "SelectionPolicy.hpp"
+#include "Topology.hpp"
+#include <cmath>
+#include <random>
+
+/** Usage text printed on -h or a bad option */
+static const string usage =
+    "Usage: untitled [options]\n"
+    "  -s, --schedule MODE   shared (one locked table), steal (per-kid deques),\n"
+    "                        scan (SIMD scan of packed job columns, lock-free claims)\n"
+    "                        or priority (per-strategy heaps, best aged value first)\n"
+    "  -k, --kids N          number of kid threads (default 4)\n"
+    "  -t, --table N         number of JobTable slots (default 10)\n"
+    "  -d, --duration SEC    length of the run in seconds (default 21)\n"
+    "  -b, --batch K         reserve up to K jobs per lock in shared mode, fewer when\n"
+    "                        they are slow: claiming stops once their slow adds up to K (default 1)\n"
+    "  -a, --aging RATE      priority mode: value a waiting job gains per second waited, so\n"
+    "                        cheap jobs are not left forever; 0 ranks by value alone (default 1)\n"
+    "  -w, --work N          give every job a CPU task of slow x N hash rounds, run by the kid\n"
+    "                        instead of sleeping; 0 makes empty tasks (default: no tasks)\n"
+    "  -D, --deps K          every new job waits for K jobs picked at random among the last --table\n"
+    "                        jobs Mom created, and is only posted once they are done (default 0)\n"
+    "  -u, --tick USEC       microseconds a kid sleeps per unit of a job's slow rating in real time;\n"
+    "                        0 runs jobs back to back (default 1000000)\n"
+    "  -M, --moods LIST      comma-separated strategy names dealt to kids in turn, e.g. lazy,greedy\n"
+    "                        (default: each kid rolls one)\n"
+    "  -q, --quiet           skip per-job text; the summary lists totals per kid\n"
+    "  -c, --clock MODE      real (kid threads sleep through each job) or virtual\n"
+    "                        (one thread replays the run on a simulated clock, -d in simulated seconds)\n"
+    "  -x, --control MODE    signal (SIGUSR1 to start, SIGQUIT to stop) or token (start latch,\n"
+    "                        jthread stop tokens; kids stop after their current job)\n"
+    "  -p, --pool N          run kids as coroutines on N OS threads instead of a thread each;\n"
+    "                        shared and priority schedules and the real clock only, replaces\n"
+    "                        --control (default 0: off)\n"
+    "  -o, --processes       run each kid as a worker process on a table in POSIX shared memory;\n"
+    "                        jobs a crashed worker claimed go back on the table. Shared schedule\n"
+    "                        and real clock only, replaces --control (default: threads)\n"
+    "  -P, --pin CPUS        pin kid threads to these CPUs in turn, e.g. 0-3,8-11, or numa for\n"
+    "                        every CPU dealt round-robin across the NUMA nodes (default: no pinning)\n"
+    "  -S, --shards N        split the JobTable into N shards, each with its own lock and buckets\n"
+    "                        and its jobs on its own NUMA node, or numa for one per node; kids claim\n"
+    "                        from their node's shard first (shared and priority schedules, default 1)\n"
+    "  -l, --log MODE        sync (write inline), async (per-thread rings + flusher thread)\n"
+    "                        or binary (fixed-size events in a memory-mapped file)\n"
+    "  -e, --events FILE     binary event log path (default events.bin)\n"
+    "  -L, --leaderboard SEC print the live leaderboard every SEC (real or simulated) seconds\n"
+    "  -m, --metrics PREFIX  record per-thread latency histograms and write PREFIX.json and\n"
+    "                        PREFIX.prom (Prometheus text format) every second and at the end\n"
+    "  -i, --input FILE      post the jobs of FILE in order instead of random ones: a job file written\n"
+    "                        by eventdump --jobs, or CSV lines of slow,dirty,heavy; the run ends early\n"
+    "                        once every job is done\n"
+    "  -W, --ledger DIR      append every completion to DIR/ledger.bin and snapshot the table to\n"
+    "                        DIR/snapshot.bin; a run with an existing DIR resumes from them\n"
+    "  -g, --commit MS       ledger group commit window: one fdatasync per MS milliseconds of\n"
+    "                        completions, 0 to sync each batch at once (default 10)\n"
+    "  -n, --snapshot SEC    seconds between table snapshots, simulated with -c virtual;\n"
+    "                        0 snapshots only at the start and end (default 10)\n"
+    "  -T, --trace FILE      record claim, job, announce, idle and refill slices per kid and for Mom\n"
+    "                        and write them to FILE as Chrome trace-event JSON (open in Perfetto)\n"
+    "  -r, --seed N          seed for jobs and moods; a run with the same seed and options\n"
+    "                        rolls the same jobs and moods (default: random, printed at startup)\n"
+    "  -h, --help            show this message\n";
+
+/**
+ * Reads a whole-number option value<br>
+ * --------------------------------------------------
+ * @param arg Text given on the command line
+ * @param what Option name used in the error message
+ * @param low Smallest accepted value
+ * @return The parsed value; exits through fatal() if it is not a number >= low
+ */
+static int parseCount(const char* arg, const string& what, long low) {
+    char* end = nullptr;
+    errno = 0;
+    long value = strtol(arg, &end, 10);
+    if (errno != 0 || end == arg || *end != '\0' || value < low || value > numeric_limits<int>::max()) {
+        fatal("Bad value for " + what + ": " + string(arg) + "\n" + usage);
+    }
+    return static_cast<int>(value);
+}
+
+/**
+ * Reads a 64-bit seed<br>
+ * --------------------------------------------------
+ * @param arg Text given on the command line
+ * @return The parsed seed; exits through fatal() if it is not an unsigned number
+ */
+static uint64_t parseSeed(const char* arg) {
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long value = strtoull(arg, &end, 0);
+    if (errno != 0 || end == arg || *end != '\0' || arg[0] == '-') {
+        fatal("Bad value for --seed: " + string(arg) + "\n" + usage);
+    }
+    return value;
+}
+
+/**
+ * Reads a non-negative rate<br>
+ * --------------------------------------------------
+ * @param arg Text given on the command line
+ * @param what Option name used in the error message
+ * @return The parsed value; exits through fatal() if it is not a number >= 0
+ */
+static double parseRate(const char* arg, const string& what) {
+    char* end = nullptr;
+    errno = 0;
+    double value = strtod(arg, &end);
+    if (errno != 0 || end == arg || *end != '\0' || !(value >= 0) || isinf(value)) {
+        fatal("Bad value for " + what + ": " + string(arg) + "\n" + usage);
+    }
+    return value;
+}
+
+/**
+ * Looks up an enum value by its display name<br>
+ * --------------------------------------------------
+ * @param arg Text given on the command line
+ * @param names Display names, indexed by enum value
+ * @param count Number of names
+ * @param what Option name used in the error message
+ * @return Index of the matching name; exits through fatal() if none matches
+ */
+static int parseName(const char* arg, const string names[], int count, const string& what) {
+    for (int i = 0; i < count; i++) {
+        if (caseInsensitiveEquals(arg, names[i])) return i;
+    }
+    fatal("Unknown " + what + " mode: " + string(arg) + "\n" + usage);
+    return 0;
+}
+
+/**
+ * Reads a strategy list<br>
+ * --------------------------------------------------
+ * - Names are matched case-insensitively against every registered strategy,
+ *   including custom ones.
+ * @param arg Comma-separated names given on the command line
+ * @return StrategyRegistry indices in the given order; exits through fatal() on an unknown name
+ */
+static vector<int> parseMoods(const char* arg) {
+    vector<int> moods;
+    stringstream list(arg);
+    string name;
+    while (getline(list, name, ',')) {
+        int index = StrategyRegistry::find(name);
+        if (index < 0) fatal("Unknown strategy for --moods: " + name + "\n" + usage);
+        moods.push_back(index);
+    }
+    if (moods.empty()) fatal("Bad value for --moods: " + string(arg) + "\n" + usage);
+    return moods;
+}
+
+/**
+ * Reads the CPUs to pin kids to<br>
+ * --------------------------------------------------
+ * @param arg "numa", or a CPU list such as 0-3,8
+ * @return CPUs in the order kids take them; exits through fatal() on a bad list
+ */
+static vector<int> parsePin(const char* arg) {
+    if (caseInsensitiveEquals(arg, "numa")) return Topology::spreadCpus();
+    vector<int> cpus;
+    if (!Topology::parseCpuList(arg, cpus)) fatal("Bad value for --pin: " + string(arg) + "\n" + usage);
+    return cpus;
+}
+
+/**
+ * Parses the command line<br>
+ * --------------------------------------------------
+ * - Uses getopt_long so both short and long forms work.
+ * - Mode names are matched case-insensitively against their name tables.
+ * @param argc Argument count
+ * @param argv Argument vector
+ * @return Config with defaults for anything not given
+ */
+Config parseArgs(int argc, char* argv[]) {
+    Config config;
+    random_device entropy;
+    config.seed = uint64_t(entropy()) << 32 | entropy();
+    const option longOptions[] = {
+        {"schedule", required_argument, nullptr, 's'},
+        {"kids",     required_argument, nullptr, 'k'},
+        {"table",    required_argument, nullptr, 't'},
+        {"duration", required_argument, nullptr, 'd'},
+        {"batch",    required_argument, nullptr, 'b'},
+        {"aging",    required_argument, nullptr, 'a'},
+        {"work",     required_argument, nullptr, 'w'},
+        {"deps",     required_argument, nullptr, 'D'},
+        {"tick",     required_argument, nullptr, 'u'},
+        {"moods",    required_argument, nullptr, 'M'},
+        {"quiet",    no_argument,       nullptr, 'q'},
+        {"clock",    required_argument, nullptr, 'c'},
+        {"control",  required_argument, nullptr, 'x'},
+        {"pool",     required_argument, nullptr, 'p'},
+        {"processes", no_argument,     nullptr, 'o'},
+        {"pin",      required_argument, nullptr, 'P'},
+        {"shards",   required_argument, nullptr, 'S'},
+        {"log",      required_argument, nullptr, 'l'},
+        {"events",   required_argument, nullptr, 'e'},
+        {"leaderboard", required_argument, nullptr, 'L'},
+        {"metrics",  required_argument, nullptr, 'm'},
+        {"input",    required_argument, nullptr, 'i'},
+        {"ledger",   required_argument, nullptr, 'W'},
+        {"commit",   required_argument, nullptr, 'g'},
+        {"snapshot", required_argument, nullptr, 'n'},
+        {"trace",    required_argument, nullptr, 'T'},
+        {"seed",     required_argument, nullptr, 'r'},
+        {"help",     no_argument,       nullptr, 'h'},
+        {nullptr,    0,                 nullptr, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "s:k:t:d:b:a:w:D:u:M:qc:x:p:oP:S:l:e:L:m:i:W:g:n:T:r:h", longOptions, nullptr)) != -1) {
+        switch (opt) {
+            case 's':
+                config.schedule = static_cast<SchedMode>(parseName(optarg, schedModeName, 4, "schedule"));
+                break;
+            case 'c':
+                config.clock = static_cast<ClockMode>(parseName(optarg, clockModeName, 2, "clock"));
+                break;
+            case 'x':
+                config.control = static_cast<ControlMode>(parseName(optarg, controlModeName, 2, "control"));
+                break;
+            case 'p':
+                config.pool = parseCount(optarg, "--pool", 0);
+                break;
+            case 'o':
+                config.processes = true;
+                break;
+            case 'P':
+                config.pinCpus = parsePin(optarg);
+                break;
+            case 'S':
+                config.shards = caseInsensitiveEquals(optarg, "numa") ? static_cast<int>(Topology::nodes().size())
+                                                                      : parseCount(optarg, "--shards", 1);
+                break;
+            case 'l':
+                config.log = static_cast<LogMode>(parseName(optarg, logModeName, 3, "log"));
+                break;
+            case 'e':
+                config.eventFile = optarg;
+                break;
+            case 'k':
+                config.kids = parseCount(optarg, "--kids", 1);
+                break;
+            case 't':
+                config.tableSize = parseCount(optarg, "--table", 1);
+                break;
+            case 'd':
+                config.duration = parseCount(optarg, "--duration", 0);
+                break;
+            case 'b':
+                config.batch = parseCount(optarg, "--batch", 1);
+                break;
+            case 'a':
+                config.aging = parseRate(optarg, "--aging");
+                break;
+            case 'w':
+                config.work = parseCount(optarg, "--work", 0);
+                break;
+            case 'D':
+                config.deps = parseCount(optarg, "--deps", 0);
+                break;
+            case 'u':
+                config.tick = parseCount(optarg, "--tick", 0);
+                break;
+            case 'M':
+                config.moods = parseMoods(optarg);
+                break;
+            case 'q':
+                config.quiet = true;
+                break;
+            case 'L':
+                config.leaderboardEvery = parseCount(optarg, "--leaderboard", 0);
+                break;
+            case 'm':
+                config.metricsPrefix = optarg;
+                break;
+            case 'i':
+                config.inputFile = optarg;
+                break;
+            case 'W':
+                config.ledgerDir = optarg;
+                break;
+            case 'g':
+                config.commitMillis = parseCount(optarg, "--commit", 0);
+                break;
+            case 'n':
+                config.snapshotEvery = parseCount(optarg, "--snapshot", 0);
+                break;
+            case 'T':
+                config.traceFile = optarg;
+                break;
+            case 'r':
+                config.seed = parseSeed(optarg);
+                break;
+            case 'h':
+                cout << usage;
+                exit(0);
+            default:
+                fatal(usage);
+        }
+    }
+    if (config.pool > 0 && config.schedule != SchedMode::SHARED && config.schedule != SchedMode::PRIORITY) {
+        fatal("--pool needs the shared or priority schedule: coroutine kids park on ready buckets\n" + usage);
+    }
+    if (config.pool > 0 && config.clock == ClockMode::VIRTUAL) {
+        fatal("--pool runs kids as coroutines on real threads; the virtual clock runs every kid on Mom's thread\n" + usage);
+    }
+    if (config.shards > 1 && config.schedule != SchedMode::SHARED && config.schedule != SchedMode::PRIORITY) {
+        fatal("--shards needs the shared or priority schedule: shards split the ready buckets\n" + usage);
+    }
+    if (config.shards > 1 && config.pool > 0) {
+        fatal("--shards does not combine with --pool: coroutine kids only park on their home shard\n" + usage);
+    }
+    if (config.shards > config.tableSize) {
+        fatal("--shards cannot exceed the number of table slots\n" + usage);
+    }
+    if (!config.pinCpus.empty() && (config.pool > 0 || config.clock == ClockMode::VIRTUAL)) {
+        fatal("--pin pins kid threads, which --pool and the virtual clock do not have\n" + usage);
+    }
+    if (!config.inputFile.empty() && !config.ledgerDir.empty()) {
+        fatal("--input does not combine with --ledger: a restored table does not know its place in the input\n" + usage);
+    }
+    if (!config.traceFile.empty() && config.clock == ClockMode::VIRTUAL) {
+        fatal("--trace records wall-clock times, which the virtual clock does not have\n" + usage);
+    }
+    if (config.processes && (config.schedule != SchedMode::SHARED || config.clock == ClockMode::VIRTUAL)) {
+        fatal("--processes needs the shared schedule and the real clock\n" + usage);
+    }
+    if (config.processes && (config.pool > 0 || config.shards > 1 || !config.pinCpus.empty() || config.work >= 0 || config.deps > 0
+                             || !config.ledgerDir.empty() || !config.traceFile.empty() || config.batch > 1)) {
+        fatal("--processes does not combine with --pool, --shards, --pin, --work, --deps, --ledger, --trace or --batch:\n"
+              "worker processes only share the job ratings, one claim at a time\n" + usage);
+    }
+    return config;
+}
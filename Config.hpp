@@ -0,0 +1,47 @@
+#pragma once
+#include "tools.hpp"
+#include "Enums.hpp"
+
+/**
+ * Config struct<br>
+ * ------------------------------------------------------<br>
+ * - Startup options for a dispatcher run, filled from the command line.<br>
+ * - Passed to Mom, who sizes the table and picks the scheduling path.<br>
+ */
+struct Config {
+    SchedMode schedule = SchedMode::SHARED;   ///< How jobs reach the kids
+    int kids = 4;                             ///< Number of Kid worker threads
+    int tableSize = 10;                       ///< Number of slots in the JobTable
+    int duration = 21;                        ///< Length of the run in seconds
+    int batch = 1;                            ///< Work, in units of Job::slow, a kid reserves per claim
+    double aging = 1.0;                       ///< Value a waiting job gains per second in PRIORITY mode
+    long work = -1;                           ///< Hash rounds per unit of Job::slow each job's task runs, -1 for no tasks
+    int deps = 0;                             ///< Predecessors each new job waits for, drawn from the jobs created before it
+    long tick = 1000000;                      ///< Microseconds a kid sleeps per unit of Job::slow in real time
+    vector<int> moods;                        ///< StrategyRegistry indices dealt to kids in turn, empty to roll them
+    bool quiet = false;                       ///< Skips per-job text; the summary lists totals per kid
+    ClockMode clock = ClockMode::REAL;        ///< Kid threads sleeping in real time, or a simulated clock
+    ControlMode control = ControlMode::SIGNAL; ///< How real-time kids are started and stopped
+    int pool = 0;                             ///< OS threads running the kids as coroutines, 0 for a thread per kid
+    bool processes = false;                   ///< Kids run as worker processes on a table in POSIX shared memory
+    vector<int> pinCpus;                      ///< CPUs kid threads are pinned to, dealt in turn; empty for no pinning
+    int shards = 1;                           ///< JobTable shards, spread over the NUMA nodes
+    int leaderboardEvery = 0;                 ///< Seconds between live leaderboard lines, 0 for none
+    string metricsPrefix;                     ///< Where metrics are exported (prefix.json, prefix.prom), empty for none
+    string inputFile;                         ///< Recorded jobs to post instead of random ones, empty for none
+    string ledgerDir;                         ///< Directory of the completion ledger and table snapshots, empty for none
+    int commitMillis = 10;                    ///< Ledger group commit window in milliseconds
+    int snapshotEvery = 10;                   ///< Seconds between table snapshots, real or simulated; 0 for start and end only
+    string traceFile;                         ///< Chrome trace-event JSON written at the end, empty for none
+    uint64_t seed = 0;                        ///< Run seed for every Rng stream, random unless --seed is given
+    LogMode log = LogMode::SYNC;              ///< Text inline, text through a flusher thread, or binary events
+    string eventFile = "events.bin";          ///< Binary event log path used with LogMode::BINARY
+};
+
+/** Parses command line options into a Config<br>
+ * Unknown options or values print usage and exit through fatal().<br>
+ * @param argc Argument count from main<br>
+ * @param argv Argument vector from main<br>
+ * @return The parsed configuration
+ */
+Config parseArgs(int argc, char* argv[]);
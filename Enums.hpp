@@ -11,3 +11,32 @@ enum class JobStatus {
 
 const string jobStatusName[]={"NOT_STARTED", "WORKING", "COMPLETE"};
 
+enum class SchedMode {
+    SHARED, STEAL, SCAN, PRIORITY
+    };
+
+const string schedModeName[]={"SHARED", "STEAL", "SCAN", "PRIORITY"};
+
+enum class LogMode {
+    SYNC, ASYNC, BINARY
+    };
+
+const string logModeName[]={"SYNC", "ASYNC", "BINARY"};
+
+enum class ClockMode {
+    REAL, VIRTUAL
+    };
+
+const string clockModeName[]={"REAL", "VIRTUAL"};
+
+enum class ControlMode {
+    SIGNAL, TOKEN
+    };
+
+const string controlModeName[]={"SIGNAL", "TOKEN"};
+
+enum class EventType : uint8_t {
+    NONE, JOB_POSTED, JOB_REFILLED, JOB_CLAIMED, JOB_DONE, KID_START
+    };
+
+const string eventTypeName[]={"NONE", "JOB_POSTED", "JOB_REFILLED", "JOB_CLAIMED", "JOB_DONE", "KID_START"};
@@ -0,0 +1,198 @@
+#include "EventLog.hpp"
+#include "Job.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * Static instance initialization for the singleton EventLog.<br>
+ */
+EventLog EventLog::instance;
+
+/**
+ * Reads the event clock<br>
+ * --------------------------------------------------
+ * - The TSC on x86 (a few ns, calibrated against CLOCK_MONOTONIC at close).
+ * - CLOCK_MONOTONIC nanoseconds elsewhere.
+ */
+static inline uint64_t readTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    timespec now{};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return uint64_t(now.tv_sec) * 1000000000ull + uint64_t(now.tv_nsec);
+#endif
+}
+
+/** Reads CLOCK_MONOTONIC in nanoseconds */
+static int64_t monotonicNs() {
+    timespec now{};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return int64_t(now.tv_sec) * 1000000000ll + now.tv_nsec;
+}
+
+/** Constructor: initializes the grow lock */
+EventLog::EventLog() {
+    pthread_mutex_init(&growLock, nullptr);
+}
+
+/** Destructor: closes the log if the program did not */
+EventLog::~EventLog() {
+    close();
+    pthread_mutex_destroy(&growLock);
+}
+
+/**
+ * Creates and maps the log file<br>
+ * --------------------------------------------------
+ * - Reserves the header page and the first chunk on disk.
+ * - Maps the first chunk with MAP_POPULATE so early events do not fault.
+ * @param path File to create
+ * @return true on success
+ */
+bool EventLog::open(const string& path) {
+    if (instance.on.load()) return true;
+    instance.fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (instance.fd < 0) return false;
+    if (posix_fallocate(instance.fd, 0, headerBytes + chunkBytes) != 0) {
+        ::close(instance.fd);
+        instance.fd = -1;
+        return false;
+    }
+    void* page = mmap(nullptr, headerBytes, PROT_READ | PROT_WRITE, MAP_SHARED, instance.fd, 0);
+    if (page == MAP_FAILED) {
+        ::close(instance.fd);
+        instance.fd = -1;
+        return false;
+    }
+
+    instance.header = static_cast<EventLogHeader*>(page);
+    memcpy(instance.header->magic, "TDEVLOG1", 8);
+    instance.header->version = 1;
+    instance.header->recordSize = sizeof(EventRecord);
+    instance.header->count = 0;
+    timespec wall{};
+    clock_gettime(CLOCK_REALTIME, &wall);
+    instance.header->startUnixNs = int64_t(wall.tv_sec) * 1000000000ll + wall.tv_nsec;
+    instance.startNs = monotonicNs();
+    instance.header->startTicks = readTicks();
+    instance.header->ticksPerNs = 1.0;
+
+    instance.next.store(0);
+    instance.dropped.store(0);
+    if (mapChunk(0) == nullptr) {
+        munmap(instance.header, headerBytes);
+        ::close(instance.fd);
+        instance.fd = -1;
+        return false;
+    }
+    instance.on.store(true, memory_order_release);
+    return true;
+}
+
+/**
+ * Maps one chunk of the log<br>
+ * --------------------------------------------------
+ * - Double-checked under growLock so only one thread grows the file.
+ * - Extends the file with posix_fallocate, then maps the new range.
+ * - Writes one byte per page up front: a shared file mapping takes a
+ *   write fault on each page's first store, which would otherwise land
+ *   on the hot path of whichever kid records there.
+ * @param chunk Chunk index
+ * @return The chunk's first record, or nullptr if it cannot be mapped
+ */
+EventRecord* EventLog::mapChunk(size_t chunk) {
+    if (chunk >= maxChunks) return nullptr;
+    EventRecord* mapped = instance.chunks[chunk].load(memory_order_acquire);
+    if (mapped != nullptr) return mapped;
+
+    pthread_mutex_lock(&instance.growLock);
+    mapped = instance.chunks[chunk].load(memory_order_relaxed);
+    if (mapped == nullptr) {
+        off_t offset = off_t(headerBytes + chunk * chunkBytes);
+        void* range = MAP_FAILED;
+        if (posix_fallocate(instance.fd, offset, chunkBytes) == 0) {
+            range = mmap(nullptr, chunkBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, instance.fd, offset);
+        }
+        if (range != MAP_FAILED) {
+            volatile char* bytes = static_cast<char*>(range);
+            for (size_t page = 0; page < chunkBytes; page += 4096) bytes[page] = 0;
+            mapped = static_cast<EventRecord*>(range);
+            instance.chunks[chunk].store(mapped, memory_order_release);
+        }
+    }
+    pthread_mutex_unlock(&instance.growLock);
+    return mapped;
+}
+
+/**
+ * Appends one event<br>
+ * --------------------------------------------------
+ * - Claims an index with one fetch_add and writes the record in place.
+ * - The writer that reaches the middle of a chunk maps the next one.
+ * - Events past the last chunk are counted as dropped.
+ */
+void EventLog::record(EventType type, int kid, int jobNumber, const Job* job, Mood mood) {
+    uint64_t index = instance.next.fetch_add(1, memory_order_relaxed);
+    size_t chunk = index / chunkRecords;
+    size_t offset = index % chunkRecords;
+    if (offset == chunkRecords / 2) mapChunk(chunk + 1);
+
+    if (chunk >= maxChunks) {
+        instance.dropped.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+    EventRecord* base = instance.chunks[chunk].load(memory_order_acquire);
+    if (base == nullptr && (base = mapChunk(chunk)) == nullptr) {
+        instance.dropped.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+
+    EventRecord& entry = base[offset];
+    entry.ticks = readTicks();
+    entry.job = static_cast<uint32_t>(jobNumber);
+    entry.kid = static_cast<uint16_t>(kid);
+    entry.mood = static_cast<uint8_t>(mood);
+    if (job != nullptr) {
+        entry.value = static_cast<uint16_t>(job->value);
+        entry.slow = static_cast<uint8_t>(job->slow);
+        entry.dirty = static_cast<uint8_t>(job->dirty);
+        entry.heavy = static_cast<uint8_t>(job->heavy);
+    }
+    entry.type = type;
+}
+
+/**
+ * Closes the log<br>
+ * --------------------------------------------------
+ * - Stores the record count and the measured tick rate in the header.
+ * - Trims the pre-allocated tail so the file holds exactly the records handed out;
+ *   slots lost to a failed mapping stay NONE and are skipped by readers.
+ * - Reports dropped events on cerr.
+ * - Call only after every thread that records events has stopped.
+ */
+void EventLog::close() {
+    if (!instance.on.exchange(false)) return;
+
+    uint64_t count = min<uint64_t>(instance.next.load(), maxChunks * chunkRecords);
+    int64_t elapsedNs = monotonicNs() - instance.startNs;
+    uint64_t elapsedTicks = readTicks() - instance.header->startTicks;
+    instance.header->count = count;
+    instance.header->ticksPerNs = elapsedNs > 0 ? double(elapsedTicks) / double(elapsedNs) : 1.0;
+
+    for (atomic<EventRecord*>& chunk : instance.chunks) {
+        EventRecord* mapped = chunk.exchange(nullptr);
+        if (mapped != nullptr) munmap(mapped, chunkBytes);
+    }
+    msync(instance.header, headerBytes, MS_SYNC);
+    munmap(instance.header, headerBytes);
+    instance.header = nullptr;
+    if (ftruncate(instance.fd, off_t(headerBytes + count * sizeof(EventRecord))) != 0) perror("ftruncate");
+    ::close(instance.fd);
+    instance.fd = -1;
+
+    if (instance.dropped.load() > 0) cerr << "EventLog: " << instance.dropped.load() << " events dropped\n";
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include "tools.hpp"
+#include "Enums.hpp"
+#include <atomic>
+#include <cstdint>
+
+class Job;
+
+/**
+ * EventRecord struct<br>
+ * ------------------------------------------------------<br>
+ * - One fixed-size entry of the binary event log (32 bytes, two per cache line).<br>
+ * - type == NONE marks a slot that was never written.<br>
+ * - kid is EventLog::momId for events Mom records.<br>
+ */
+struct EventRecord {
+    uint64_t ticks;        ///< Timestamp in clock ticks, see EventLogHeader::ticksPerNs
+    uint32_t job;          ///< Job number (table slot)
+    uint16_t kid;          ///< Kid id
+    uint16_t value;        ///< Job value
+    EventType type;        ///< What happened
+    uint8_t slow;          ///< Job slow rating
+    uint8_t dirty;         ///< Job dirty rating
+    uint8_t heavy;         ///< Job heavy rating
+    uint8_t mood;          ///< Kid mood, set on KID_START
+    uint8_t reserved[11];  ///< Padding to 32 bytes
+};
+static_assert(sizeof(EventRecord) == 32, "EventRecord must stay 32 bytes");
+
+/**
+ * EventLogHeader struct<br>
+ * ------------------------------------------------------<br>
+ * - First page of the log file; records start at byte EventLog::headerBytes.<br>
+ * - count and ticksPerNs are filled in when the log is closed.
+ *   A log left by a crash has count == 0 and is read until the first NONE record.<br>
+ */
+struct EventLogHeader {
+    char magic[8];         ///< "TDEVLOG1"
+    uint32_t version;      ///< Format version, currently 1
+    uint32_t recordSize;   ///< sizeof(EventRecord)
+    uint64_t count;        ///< Number of records written
+    uint64_t startTicks;   ///< Tick count when the log was opened
+    double ticksPerNs;     ///< Tick rate measured over the run
+    int64_t startUnixNs;   ///< Wall-clock time when the log was opened
+};
+
+/**
+ * EventLog class<br>
+ * ------------------------------------------------------<br>
+ * - Singleton binary logger used instead of text output on the hot path.<br>
+ * - The file is pre-allocated and memory-mapped in fixed-size chunks;
+ *   appending is one atomic increment, one timestamp and a 32-byte store.<br>
+ * - A chunk is mapped ahead once writers are halfway through the previous one,
+ *   so writers rarely meet an unmapped chunk.<br>
+ * - eventdump turns the file back into the usual text.<br>
+ */
+class EventLog {
+private:
+    static const size_t maxChunks = 1024;          ///< 1024 chunks of 4 MiB = 4 GiB of events
+
+    static EventLog instance;                      ///< Singleton instance
+    int fd = -1;                                   ///< Log file descriptor
+    atomic<bool> on{false};                        ///< True between open() and close()
+    atomic<uint64_t> next{0};                      ///< Index of the next record to hand out
+    atomic<uint64_t> dropped{0};                   ///< Records lost after the last chunk filled
+    atomic<EventRecord*> chunks[maxChunks]{};      ///< Mapped chunks, nullptr until first use
+    pthread_mutex_t growLock;                      ///< Serializes growing the file
+    EventLogHeader* header = nullptr;              ///< Mapped header page
+    int64_t startNs = 0;                           ///< Monotonic time at open, for calibration
+
+    EventLog();
+    ~EventLog();
+
+    /** Maps a chunk if it is not mapped yet, growing the file as needed */
+    static EventRecord* mapChunk(size_t chunk);
+
+public:
+    static const size_t headerBytes = 4096;        ///< Bytes reserved for the header page
+    static const size_t chunkBytes = 4 << 20;      ///< Bytes per mapped chunk
+    static const size_t chunkRecords = chunkBytes / sizeof(EventRecord);
+    static const uint16_t momId = 0xFFFF;          ///< Kid id used for Mom's events
+
+    /** Creates the log file and maps the header and first chunk<br>
+     * @param path File to create (truncated if it exists)<br>
+     * @return false if the file could not be created or mapped
+     */
+    static bool open(const string& path);
+
+    /** Writes the final count and tick rate, trims the file and unmaps it */
+    static void close();
+
+    /** True while the binary log is the active event sink */
+    static bool enabled() { return instance.on.load(memory_order_relaxed); }
+
+    /** Appends one event<br>
+     * @param type What happened<br>
+     * @param kid Kid id, or momId<br>
+     * @param jobNumber Job number (table slot), 0 when there is no job<br>
+     * @param job Job whose ratings are copied, or nullptr<br>
+     * @param mood Kid mood, stored for KID_START
+     */
+    static void record(EventType type, int kid, int jobNumber, const Job* job = nullptr, Mood mood = Mood::LAZY);
+};
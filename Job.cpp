@@ -1,10 +1,15 @@
 #include "Job.hpp"
 #include "Printer.hpp"
+#include "JobTable.hpp"
+#include "EventLog.hpp"
+#include "Random.hpp"
+#include "Metrics.hpp"
+#include "Tracer.hpp"
 
 /**
  * Default constructor<br>
  * --------------------------------------------------<br>
- * Randomly initializes job attributes:<br>
+ * Randomly initializes job attributes from the calling thread's Rng:<br>
  * - slow: how long it takes (1–5)
  * - dirty: how messy it is (1–5)
  * - heavy: how difficult it is (1–5)
@@ -12,39 +17,122 @@
  * Sets job status to NOT_STARTED.
  */
 Job::Job(){
-    slow = rand() % 5 + 1;      // 1 is quick, 5 is long
-    dirty = rand() % 5 + 1;     // 1 is pleasant, 5 is messy
-    heavy = rand() % 5 + 1;     // 1 is easy, 5 is hard
+    Rng& rng = Rng::local();
+    slow = rng.between(1, 5);   // 1 is quick, 5 is long
+    dirty = rng.between(1, 5);  // 1 is pleasant, 5 is messy
+    heavy = rng.between(1, 5);  // 1 is easy, 5 is hard
     value = slow * (dirty + heavy);
     status = JobStatus::NOT_STARTED;
 };
 
+/**
+ * Rating constructor<br>
+ * --------------------------------------------------<br>
+ * Same as the default constructor with the ratings supplied.
+ */
+Job::Job(short slow, short dirty, short heavy): slow(slow), dirty(dirty), heavy(heavy) {
+    value = slow * (dirty + heavy);
+    status = JobStatus::NOT_STARTED;
+}
+
 /**
  * Assigns job to a kid<br>
  * --------------------------------------------------
- * - Stores the kid's name and job number
+ * - Stores the kid's id and job number
  * - Updates job status to WORKING
- * @param kidName Name of the kid accepting the job
+ * @param kidId Id of the kid accepting the job
  * @param jobNumber ID number of the job
  */
-void Job::chooseJob(const string &kidName, int jobNumber){
+void Job::chooseJob(int kidId, int jobNumber){
     this->jobNumber = jobNumber;
-    this->kidName = kidName;
+    this->kidId = kidId;
     status = JobStatus::WORKING;
 };
 
+/**
+ * Declares predecessors<br>
+ * --------------------------------------------------
+ * - unmet starts one above the predecessor count, a guard that keeps a predecessor
+ *   completing meanwhile from posting the job before every edge is in place.
+ * - Each edge is pushed with a CAS; a sealed list means that predecessor is done.
+ * - Dropping the guard tells whether the last predecessor is already gone.
+ * @param predecessors Jobs that must complete first
+ * @return true if the job is ready now
+ */
+bool Job::waitFor(span<Job* const> predecessors) {
+    edges = make_unique<Edge[]>(predecessors.size());
+    unmet.store(static_cast<int>(predecessors.size()) + 1, memory_order_relaxed);
+    for (size_t i = 0; i < predecessors.size(); i++) {
+        Edge& edge = edges[i];
+        edge.successor = this;
+        atomic<Edge*>& list = predecessors[i]->successors;
+        Edge* head = list.load(memory_order_acquire);
+        while (true) {
+            if (head == &sealed) {
+                unmet.fetch_sub(1, memory_order_relaxed);
+                break;
+            }
+            edge.next = head;
+            if (list.compare_exchange_weak(head, &edge, memory_order_release, memory_order_acquire)) break;
+        }
+    }
+    return unmet.fetch_sub(1, memory_order_acq_rel) == 1;
+}
+
 /**
  * Announces job completion<br>
  * --------------------------------------------------
+ * - Credits the job's value to its kid on the table's Leaderboard, without locking
+ * - Posts every successor it was the last unmet predecessor of, under that
+ *   successor's shard lock, before its own shard lock is taken
+ * - Logs message to file and terminal via Printer, or a JOB_DONE event in binary mode;
+ *   nothing is printed when the table is quiet
  * - Updates status to COMPLETE
- * - Logs message to file and terminal via Printer
+ * - Queues the job's slot on its shard and posts the table's semaphore, which
+ *   wakes Mom so it is refilled right away. Mom releases the job to the JobPool
+ *   when she takes the slot, so nothing touches it once it is queued.
+ * @param table Table the job was claimed from
  */
-void Job::announceDone(){
+void Job::announceDone(JobTable& table){
+    METRICS_SCOPE(Metric::ANNOUNCE);
+    ScopedTrace announce(TraceSpan::ANNOUNCE, Tracer::kidTrack(kidId), jobNumber);
+    table.scores.credit(kidId, value);
+    releaseSuccessors([&table](Job* next) { table.postReady(next->jobNumber); });
+    if (EventLog::enabled()) {
+        EventLog::record(EventType::JOB_DONE, kidId, jobNumber, this);
+    } else if (!table.quiet) {
+        ss << "Job ID:" << jobNumber << " is completed" << endl;
+        Printer::write(ss, cout);
+    }
+    JobTable::Shard& shard = table.shardOf(jobNumber);
+    METRICS_LOCK(&shard.lock);
     status = JobStatus::COMPLETE;
-    ss << "Job ID:" << jobNumber << " is completed" << endl;
-    Printer::write(ss, cout);
+    if (table.mode == SchedMode::SCAN) table.columns.setStatus(jobNumber, JobStatus::COMPLETE);
+    shard.doneSlots.push_back(jobNumber);
+    pthread_mutex_unlock(&shard.lock);
+    sem_post(&table.done);
 };
 
+/**
+ * Mood filter<br>
+ * - Runtime form of the built-in SelectionPolicy filters; the two must agree.
+ * - Nothing in the dispatcher calls it: kids and the ready buckets go through the
+ *   policies and StrategyRegistry::eligible. It is kept as the runtime-switch
+ *   baseline the filter/suits benchmark measures them against.
+ * @param mood Mood of the kid considering the job
+ * @return true if the job passes that mood's filter
+ */
+bool Job::suits(Mood mood) const {
+    switch (mood) {
+        case Mood::LAZY:        return heavy < 3;
+        case Mood::PRISSY:      return dirty < 3;
+        case Mood::OVERTIRED:   return slow < 3;
+        case Mood::GREEDY:      return value > 40;
+        case Mood::COOPERATIVE: return true;
+    }
+    return false;
+}
+
 /**
  * Prints job details<br>
  * --------------------------------------------------
@@ -1,6 +1,29 @@
 #pragma once
 #include "tools.hpp"
 #include "Enums.hpp"
+#include "Task.hpp"
+#include <atomic>
+#include <memory>
+
+class JobTable;
+
+/**
+ * CompletedJob struct<br>
+ * ------------------------------------------------------<br>
+ * - What the summaries and the ledger need of a completed job, 32 bytes.<br>
+ * - Copied out before the Job goes back to the JobPool, so a run keeps one
+ *   record per completion instead of one pool slot.<br>
+ */
+struct CompletedJob {
+    int64_t result = 0;    ///< What the task returned, if hasResult
+    int jobNumber = -1;    ///< Slot the job was claimed from
+    int kidId = -1;        ///< Kid that completed it
+    int value = 0;         ///< slow x (dirty + heavy)
+    short slow = 0;        ///< Time rating (1 to 5)
+    short dirty = 0;       ///< Dirtiness rating (1 to 5)
+    short heavy = 0;       ///< Effort rating (1 to 5)
+    bool hasResult = false;  ///< True if the job ran a task that returned a result
+};
 
 /**
  * Job class<br>
@@ -8,19 +31,37 @@
  * - Represents a single job that a kid can take on.<br>
  * - Contains attributes like job number, difficulty (slow, dirty, heavy), and value.<br>
  * - Tracks the job status and which kid is working on it.<br>
+ * - May carry a Task, the real work a kid runs instead of sleeping, and its result.<br>
+ * - May wait for predecessor jobs: it counts its unmet predecessors atomically and
+ *   is only posted once the last one completes, which hands it to the table directly.<br>
+ * - Lives in a JobPool slab; everything else refers to it through a JobHandle.<br>
  * - Used by both Mom and Kid classes.<br>
  */
 class Job {
 private:
+    /** One dependency: owned by the successor, linked into its predecessor's list */
+    struct Edge {
+        Job* successor;
+        Edge* next;
+    };
+
+    static inline Edge sealed{};  ///< Head of a completed job's successor list; no edge can be added after it
+
     int jobNumber;         ///< Unique identifier for the job
     short int slow;        ///< Time to complete the job (1 to 5)
     short int dirty;       ///< Dirtiness level (1 to 5)
     short int heavy;       ///< Weight/effort required (1 to 5)
     int value;             ///< Calculated value based on job properties
-    string kidName;        ///< Name of the kid assigned to this job
+    int kidId = -1;        ///< Id of the kid assigned to this job (see Kid::makeName)
+    double postedAt = 0;   ///< Seconds into the run, real or simulated, when Mom posted the job
+    Task task;             ///< Work to run when the job is done for real, empty to sleep instead
+    optional<int64_t> result;  ///< What the task returned, once it has run
+    atomic<int> unmet{0};      ///< Predecessors not yet complete; the job may be posted at 0
+    atomic<Edge*> successors{nullptr};  ///< Jobs waiting on this one, a lock-free stack sealed on completion
+    unique_ptr<Edge[]> edges;  ///< This job's links into its predecessors' lists, one per predecessor
 
 public:
-    JobStatus status;      ///< Current status of the job (NOT_STARTED, WORKING, COMPLETE)
+    JobStatus status;      ///< Current status of the job (NOT_STARTED, WORKING once claimed or reserved, COMPLETE)
 
     /** Default constructor<br>
      * Initializes job with random slow, dirty, heavy values.<br>
@@ -29,20 +70,88 @@ public:
      */
     Job();
 
+    /** Constructor with given ratings<br>
+     * Used by Mom to build a batch of jobs from one bulk random fill.<br>
+     * @param slow Time rating (1 to 5)<br>
+     * @param dirty Dirtiness rating (1 to 5)<br>
+     * @param heavy Effort rating (1 to 5)
+     */
+    Job(short slow, short dirty, short heavy);
+
     /** Destructor (default) */
     ~Job() = default;
 
     /** Assigns job to a kid<br>
-     * Sets jobNumber, kidName, and status to WORKING.<br>
-     * @param kidname Name of the kid taking the job<br>
+     * Sets jobNumber, kidId and status to WORKING.<br>
+     * @param kidId Id of the kid taking the job<br>
      * @param jobNumber ID of the job being assigned<br>
      */
-    void chooseJob(const string& kidname, int jobNumber);
+    void chooseJob(int kidId, int jobNumber);
 
     /** Announces job completion<br>
-     * Sets status to COMPLETE and prints message.
+     * Posts ready successors, prints message, sets status to COMPLETE, queues the slot<br>
+     * for refill and wakes Mom. Mom may release the job once it is queued.<br>
+     * @param table Table the job was claimed from
+     */
+    void announceDone(JobTable& table);
+
+    /** Makes the job wait for others<br>
+     * Call once, after the job is in its slot and before it is posted. Predecessors<br>
+     * already complete are skipped; each other one gets an edge pushed onto its<br>
+     * successor list without a lock, even while it is being completed.<br>
+     * Jobs must be created in dependency order, and only from jobs some kid will take,<br>
+     * so the oldest unfinished job a kid would take is always ready.<br>
+     * @param predecessors Jobs that must complete first<br>
+     * @return true if every predecessor is already complete and the caller must post the job
+     */
+    bool waitFor(span<Job* const> predecessors);
+
+    /** True once every predecessor has completed */
+    bool isReady() const { return unmet.load(memory_order_acquire) == 0; }
+
+    /** Seals the successor list and hands over every successor this job was the last predecessor of<br>
+     * Called once per job, when it completes; O(1) per edge, no table scan.<br>
+     * @param ready Called with each successor that just became ready
      */
-    void announceDone();
+    template <class F>
+    void releaseSuccessors(F&& ready);
+
+    /** Mood filter<br>
+     * LAZY wants heavy < 3, PRISSY dirty < 3, OVERTIRED slow < 3,<br>
+     * GREEDY value > 40, and COOPERATIVE takes anything.<br>
+     * Only the benchmarks call it, as the baseline for the selection policies.<br>
+     * @param mood Mood of the kid looking at the job<br>
+     * @return true if a kid in that mood would take this job
+     */
+    bool suits(Mood mood) const;
+
+    /** Attribute getters, used by selection policies to filter jobs inline */
+    short getSlow() const { return slow; }
+    short getDirty() const { return dirty; }
+    short getHeavy() const { return heavy; }
+    int getValue() const { return value; }
+
+    /** Attaches the work a kid runs instead of sleeping<br>
+     * The ratings stay as they are, so selection is unchanged.<br>
+     * @param work Callable to run
+     */
+    void setTask(Task&& work) { task = std::move(work); }
+
+    /** True if the job carries a task */
+    bool hasTask() const { return static_cast<bool>(task); }
+
+    /** Runs the task and keeps its result */
+    void runTask() { result = task(); }
+
+    /** Returns the task's result, empty until it has run or if it returns nothing */
+    const optional<int64_t>& getResult() const { return result; }
+
+    /** Copies out what outlives the job once it is released<br>
+     * @return The job's completion record
+     */
+    CompletedJob summary() const {
+        return {result.value_or(0), jobNumber, kidId, value, slow, dirty, heavy, result.has_value()};
+    }
 
     /** Print function<br>
      * Outputs the job’s attributes (value, slow, dirty, heavy).<br>
@@ -53,9 +162,35 @@ public:
 
     friend class Kid;  ///< Grants access to Kid class
     friend class Mom;  ///< Grants access to Mom class
+    friend class JobTable;  ///< Grants access to JobTable class
+    friend class EventLog;  ///< Grants access to EventLog class
+    friend class JobColumns;  ///< Grants access to JobColumns class
 };
 
+/** Walks the sealed list<br>
+ * The next link is read before the successor's count drops, since a successor
+ * that becomes ready may run, complete and free its edges at once.
+ */
+template <class F>
+void Job::releaseSuccessors(F&& ready) {
+    Edge* edge = successors.exchange(&sealed, memory_order_acq_rel);
+    while (edge != nullptr) {
+        Edge* next = edge->next;
+        Job* successor = edge->successor;
+        if (successor->unmet.fetch_sub(1, memory_order_acq_rel) == 1) ready(successor);
+        edge = next;
+    }
+}
+
 /** Overloaded << operator for printing jobs */
 inline ostream& operator << (ostream& out, Job& job){
     return job.print(out);
 }
+
+/** Prints a completed job the way Job::print does */
+inline ostream& operator << (ostream& out, const CompletedJob& job){
+    return out << "The job value is : " << job.value
+               << " it has " << job.slow << " slow"
+               << " it has " << job.dirty << " dirty"
+               << " it has " << job.heavy << " heavy" << endl;
+}
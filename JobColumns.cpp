@@ -0,0 +1,180 @@
+#include "JobColumns.hpp"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define JOBCOLUMNS_X86 1
+#endif
+
+/** Kernels read columns other threads write; the reads are racy by design (see JobColumns), so TSan skips them */
+#define JOBCOLUMNS_RACY_READS __attribute__((no_sanitize("thread")))
+
+/**
+ * Sizes the columns<br>
+ * --------------------------------------------------
+ * - Rounds up to whole 32-slot blocks and marks every slot EMPTY
+ *   until Mom stores a job in it.
+ * @param slots Number of table slots
+ */
+void JobColumns::resize(size_t slots) {
+    count = slots;
+    size_t padded = (slots + block - 1) / block * block;
+    slow.assign(padded, 0);
+    dirty.assign(padded, 0);
+    heavy.assign(padded, 0);
+    value.assign(padded, 0);
+    status.assign(padded, EMPTY);
+}
+
+/**
+ * Stores a job's attributes<br>
+ * --------------------------------------------------
+ * - Attributes are written first, as relaxed atomics since the kernels may be
+ *   reading them, then status with release ordering.
+ * @param slot Slot index
+ * @param job Job now in that slot
+ */
+void JobColumns::store(size_t slot, const Job& job) {
+    atomic_ref<uint8_t>(slow[slot]).store(static_cast<uint8_t>(job.slow), memory_order_relaxed);
+    atomic_ref<uint8_t>(dirty[slot]).store(static_cast<uint8_t>(job.dirty), memory_order_relaxed);
+    atomic_ref<uint8_t>(heavy[slot]).store(static_cast<uint8_t>(job.heavy), memory_order_relaxed);
+    atomic_ref<uint16_t>(value[slot]).store(static_cast<uint16_t>(job.value), memory_order_relaxed);
+    setStatus(slot, JobStatus::NOT_STARTED);
+}
+
+/**
+ * Scalar kernel<br>
+ * --------------------------------------------------
+ * - Used where no vector unit is available.
+ * - The mood is resolved once per block into "column below limit" or
+ *   "value above limit", so the inner loop is branch-free.
+ */
+JOBCOLUMNS_RACY_READS
+uint32_t eligibleScalar(const JobColumns& c, Mood mood, size_t base) {
+    const uint8_t* status = &c.status[base];
+    uint32_t mask = 0;
+    if (mood == Mood::GREEDY) {
+        const uint16_t* value = &c.value[base];
+        for (uint32_t i = 0; i < JobColumns::block; i++) mask |= uint32_t(status[i] == 0 && value[i] > 40) << i;
+        return mask;
+    }
+    const uint8_t* column = mood == Mood::LAZY ? &c.heavy[base]
+                          : mood == Mood::PRISSY ? &c.dirty[base]
+                          : mood == Mood::OVERTIRED ? &c.slow[base] : nullptr;
+    if (column == nullptr) {
+        for (uint32_t i = 0; i < JobColumns::block; i++) mask |= uint32_t(status[i] == 0) << i;
+        return mask;
+    }
+    for (uint32_t i = 0; i < JobColumns::block; i++) mask |= uint32_t(status[i] == 0 && column[i] < 3) << i;
+    return mask;
+}
+
+#ifdef JOBCOLUMNS_X86
+/**
+ * SSE2 kernel<br>
+ * --------------------------------------------------
+ * - Two 16-slot halves; values are compared as int16 and packed to bytes.
+ */
+JOBCOLUMNS_RACY_READS
+uint32_t eligibleSse2(const JobColumns& c, Mood mood, size_t base) {
+    uint32_t mask = 0;
+    const __m128i three = _mm_set1_epi8(3);
+    for (size_t half = 0; half < 2; half++) {
+        size_t s = base + half * 16;
+        __m128i ok = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&c.status[s])), _mm_setzero_si128());
+        switch (mood) {
+            case Mood::LAZY:
+                ok = _mm_and_si128(ok, _mm_cmpgt_epi8(three, _mm_loadu_si128(reinterpret_cast<const __m128i*>(&c.heavy[s]))));
+                break;
+            case Mood::PRISSY:
+                ok = _mm_and_si128(ok, _mm_cmpgt_epi8(three, _mm_loadu_si128(reinterpret_cast<const __m128i*>(&c.dirty[s]))));
+                break;
+            case Mood::OVERTIRED:
+                ok = _mm_and_si128(ok, _mm_cmpgt_epi8(three, _mm_loadu_si128(reinterpret_cast<const __m128i*>(&c.slow[s]))));
+                break;
+            case Mood::GREEDY: {
+                const __m128i forty = _mm_set1_epi16(40);
+                __m128i lo = _mm_cmpgt_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&c.value[s])), forty);
+                __m128i hi = _mm_cmpgt_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&c.value[s + 8])), forty);
+                ok = _mm_and_si128(ok, _mm_packs_epi16(lo, hi));
+                break;
+            }
+            case Mood::COOPERATIVE:
+                break;
+        }
+        mask |= static_cast<uint32_t>(_mm_movemask_epi8(ok)) << (half * 16);
+    }
+    return mask;
+}
+
+/**
+ * AVX2 kernel<br>
+ * --------------------------------------------------
+ * - All 32 slots in one register; the int16 value compare is packed
+ *   per 128-bit lane, so a 64-bit permute restores slot order.
+ */
+__attribute__((target("avx2"))) JOBCOLUMNS_RACY_READS
+uint32_t eligibleAvx2(const JobColumns& c, Mood mood, size_t base) {
+    const __m256i three = _mm256_set1_epi8(3);
+    __m256i ok = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&c.status[base])), _mm256_setzero_si256());
+    switch (mood) {
+        case Mood::LAZY:
+            ok = _mm256_and_si256(ok, _mm256_cmpgt_epi8(three, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&c.heavy[base]))));
+            break;
+        case Mood::PRISSY:
+            ok = _mm256_and_si256(ok, _mm256_cmpgt_epi8(three, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&c.dirty[base]))));
+            break;
+        case Mood::OVERTIRED:
+            ok = _mm256_and_si256(ok, _mm256_cmpgt_epi8(three, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&c.slow[base]))));
+            break;
+        case Mood::GREEDY: {
+            const __m256i forty = _mm256_set1_epi16(40);
+            __m256i lo = _mm256_cmpgt_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&c.value[base])), forty);
+            __m256i hi = _mm256_cmpgt_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&c.value[base + 16])), forty);
+            ok = _mm256_and_si256(ok, _mm256_permute4x64_epi64(_mm256_packs_epi16(lo, hi), 0xD8));
+            break;
+        }
+        case Mood::COOPERATIVE:
+            break;
+    }
+    return static_cast<uint32_t>(_mm256_movemask_epi8(ok));
+}
+#endif
+
+/** Kernel signature shared by the three implementations */
+using EligibleKernel = uint32_t (*)(const JobColumns&, Mood, size_t);
+
+/**
+ * Picks the widest kernel the CPU supports<br>
+ * --------------------------------------------------
+ * @param name Receives the kernel's name
+ * @return Kernel function
+ */
+static EligibleKernel pickKernel(const char*& name) {
+#ifdef JOBCOLUMNS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) { name = "avx2"; return eligibleAvx2; }
+    name = "sse2";
+    return eligibleSse2;
+#else
+    name = "scalar";
+    return eligibleScalar;
+#endif
+}
+
+static const char* kernel = nullptr;                  ///< Name of the chosen kernel
+static const EligibleKernel chosen = pickKernel(kernel);  ///< Kernel used by eligible()
+
+/**
+ * Evaluates one block<br>
+ * --------------------------------------------------
+ * @param mood Mood filter
+ * @param base First slot of the block
+ * @return Bitmask of claimable slots in the block
+ */
+uint32_t JobColumns::eligible(Mood mood, size_t base) const {
+    return chosen(*this, mood, base);
+}
+
+/** Returns the name of the kernel in use */
+const char* JobColumns::kernelName() {
+    return kernel;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "tools.hpp"
+#include "Enums.hpp"
+#include "Job.hpp"
+#include <atomic>
+
+/**
+ * JobColumns class<br>
+ * ------------------------------------------------------<br>
+ * - Structure-of-arrays copy of the table's job attributes, one entry per slot:
+ *   packed uint8_t slow/dirty/heavy/status and uint16_t value.<br>
+ * - eligible() tests a mood's filter over 32 consecutive slots at once and
+ *   returns a bitmask of the ones a kid in that mood could claim.<br>
+ * - The kernel is AVX2 or SSE2 on x86, picked once at startup, with a scalar fallback.<br>
+ * - Arrays are padded to a multiple of 32 slots; padding has status EMPTY and never matches.<br>
+ * - status is the claim word in SCAN mode: tryClaim flips it with a CAS.<br>
+ * - Every write goes through atomic_ref. The kernels' vector loads are plain and
+ *   deliberately racy: they may see a slot half refilled, or a status a kid is
+ *   CASing, which at worst sets a wrong bit or misses one for a pass. Kids re-check
+ *   the Job after winning tryClaim, so a wrong bit is never acted on. The kernels
+ *   are left out of ThreadSanitizer's instrumentation for that reason.<br>
+ */
+class JobColumns {
+private:
+    size_t count = 0;              ///< Number of real slots
+    vector<uint8_t> slow;          ///< Slow rating per slot
+    vector<uint8_t> dirty;         ///< Dirty rating per slot
+    vector<uint8_t> heavy;         ///< Heavy rating per slot
+    vector<uint8_t> status;        ///< JobStatus per slot, or EMPTY for padding
+    vector<uint16_t> value;        ///< Value per slot
+
+    friend uint32_t eligibleScalar(const JobColumns&, Mood, size_t);
+    friend uint32_t eligibleSse2(const JobColumns&, Mood, size_t);
+    friend uint32_t eligibleAvx2(const JobColumns&, Mood, size_t);
+
+public:
+    static constexpr size_t block = 32;        ///< Slots tested per eligible() call
+    static constexpr uint8_t EMPTY = 0xFF;     ///< Status of padding slots
+
+    /** Sizes the arrays for a table<br>
+     * @param slots Number of table slots
+     */
+    void resize(size_t slots);
+
+    /** Copies a job's attributes into a slot and marks it NOT_STARTED.<br>
+     * The attribute stores are relaxed atomics; the status store is a release,<br>
+     * so a kid whose tryClaim succeeds sees the new attributes.<br>
+     * @param slot Slot index<br>
+     * @param job Job just placed in the slot
+     */
+    void store(size_t slot, const Job& job);
+
+    /** Sets a slot's status<br>
+     * @param slot Slot index<br>
+     * @param state New status
+     */
+    void setStatus(size_t slot, JobStatus state) {
+        atomic_ref<uint8_t>(status[slot]).store(static_cast<uint8_t>(state), memory_order_release);
+    }
+
+    /** Claims a slot by moving it from NOT_STARTED to WORKING<br>
+     * @param slot Slot index<br>
+     * @return true if this caller won the slot
+     */
+    bool tryClaim(size_t slot) {
+        uint8_t expected = static_cast<uint8_t>(JobStatus::NOT_STARTED);
+        return atomic_ref<uint8_t>(status[slot]).compare_exchange_strong(
+            expected, static_cast<uint8_t>(JobStatus::WORKING), memory_order_acquire, memory_order_relaxed);
+    }
+
+    /** Evaluates a mood's filter over one block of slots<br>
+     * @param mood Mood whose filter to apply (COOPERATIVE only needs NOT_STARTED)<br>
+     * @param base First slot of the block, a multiple of 32<br>
+     * @return Bit i set when slot base + i is NOT_STARTED and passes the filter
+     */
+    uint32_t eligible(Mood mood, size_t base) const;
+
+    /** Number of real slots */
+    size_t size() const { return count; }
+
+    /** Number of 32-slot blocks, including the padded last one */
+    size_t blocks() const { return status.size() / block; }
+
+    /** Name of the kernel eligible() dispatches to: "avx2", "sse2" or "scalar" */
+    static const char* kernelName();
+};
@@ -0,0 +1,105 @@
+#include "JobPool.hpp"
+#include "Topology.hpp"
+
+/** Slabs are page-aligned so a lane's node preference covers exactly its slabs */
+static const align_val_t slabAlign{4096};
+
+/**
+ * Constructor<br>
+ * --------------------------------------------------
+ * - Allocates the slab directory; slabs themselves come on demand.
+ */
+JobPool::JobPool(): slabs(new atomic<Slab*>[maxSlabs]), lanes(1) {
+    for (uint32_t s = 0; s < maxSlabs; s++) slabs[s].store(nullptr, memory_order_relaxed);
+}
+
+/**
+ * Destructor<br>
+ * --------------------------------------------------
+ * - Runs ~Job for every slot whose generation is odd (live).
+ * - Frees every slab, so nothing a run created is leaked.
+ */
+JobPool::~JobPool() {
+    for (uint32_t s = 0; s < slabCount; s++) {
+        Slab* slab = slabs[s].load(memory_order_relaxed);
+        for (uint32_t i = 0; i < slabJobs; i++) {
+            if (slab->generation[i].load(memory_order_relaxed) & 1) slab->job(i)->~Job();
+        }
+        slab->~Slab();
+        ::operator delete(slab, slabAlign);
+    }
+}
+
+/**
+ * Sets the lanes<br>
+ * --------------------------------------------------
+ * @param nodes Preferred node of each lane
+ */
+void JobPool::setLanes(const vector<int>& nodes) {
+    if (slabCount > 0) fatal("JobPool: lanes must be set before the first job");
+    lanes.assign(nodes.size(), Lane{});
+    for (size_t l = 0; l < nodes.size(); l++) lanes[l].node = nodes[l];
+}
+
+/**
+ * Takes a slot<br>
+ * --------------------------------------------------
+ * - Reuses a slot the lane released when one is free, otherwise takes the
+ *   next fresh one and gives the lane a new slab every 4096 jobs.
+ * - A new slab gets the lane's node preference before anything is written to it.
+ * @param lane Lane index
+ * @return Index of the slot, still without a job
+ */
+uint32_t JobPool::takeSlot(int lane) {
+    Lane& own = lanes[lane];
+    if (!own.freeList.empty()) {
+        uint32_t index = own.freeList.back();
+        own.freeList.pop_back();
+        return index;
+    }
+    if (own.nextFresh == own.freshEnd) {
+        if (slabCount == maxSlabs) fatal("JobPool: out of slabs");
+        void* memory = ::operator new(sizeof(Slab), slabAlign);
+        if (own.node >= 0) Topology::preferNode(memory, sizeof(Slab), own.node);
+        slabs[slabCount].store(new (memory) Slab, memory_order_release);
+        slabLane.push_back(static_cast<uint16_t>(lane));
+        own.nextFresh = slabCount * slabJobs;
+        own.freshEnd = own.nextFresh + slabJobs;
+        slabCount++;
+    }
+    return own.nextFresh++;
+}
+
+/**
+ * Publishes a slot<br>
+ * --------------------------------------------------
+ * - Called once the Job has been constructed in the slot.
+ * - Bumps the generation to odd, which makes handles to it resolve.
+ * @param index Slot returned by takeSlot
+ * @return Handle carrying the new generation
+ */
+JobHandle JobPool::publish(uint32_t index) {
+    Slab* slab = slabs[index / slabJobs].load(memory_order_relaxed);
+    uint32_t i = index % slabJobs;
+    uint32_t generation = slab->generation[i].load(memory_order_relaxed) + 1;
+    slab->generation[i].store(generation, memory_order_release);
+    live++;
+    return {index, generation};
+}
+
+/**
+ * Releases a slot<br>
+ * --------------------------------------------------
+ * - Bumps the generation to even, which makes every outstanding handle
+ *   to it stale, then destroys the Job.
+ * @param handle Job to release
+ */
+void JobPool::release(JobHandle handle) {
+    Job* job = get(handle);
+    if (job == nullptr) return;
+    Slab* slab = slabs[handle.index / slabJobs].load(memory_order_relaxed);
+    slab->generation[handle.index % slabJobs].store(handle.generation + 1, memory_order_release);
+    job->~Job();
+    lanes[slabLane[handle.index / slabJobs]].freeList.push_back(handle.index);
+    live--;
+}
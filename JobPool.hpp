@@ -0,0 +1,133 @@
+#pragma once
+#include "tools.hpp"
+#include "Job.hpp"
+#include <atomic>
+#include <memory>
+
+/**
+ * JobHandle struct<br>
+ * ------------------------------------------------------<br>
+ * - Names one Job in a JobPool: a slot index plus the slot's generation.<br>
+ * - A handle goes stale when its job is released; the slot's generation
+ *   moves on and JobPool::get returns nullptr for it.<br>
+ * - Trivially copyable and 8 bytes, so it fits in an atomic.<br>
+ */
+struct JobHandle {
+    uint32_t index = UINT32_MAX;   ///< Slot in the pool, UINT32_MAX for "no job"
+    uint32_t generation = 0;       ///< Generation the slot had when the job was acquired
+
+    /** True for handles that came from JobPool::acquire */
+    bool valid() const { return index != UINT32_MAX; }
+
+    bool operator==(const JobHandle&) const = default;
+};
+
+/**
+ * JobPool class<br>
+ * ------------------------------------------------------<br>
+ * - Slab allocator for Job objects: jobs live in 4096-job slabs that never move.<br>
+ * - Released slots go on a free list and are reused before a new slab is allocated,
+ *   so steady-state refills do not touch the heap.<br>
+ * - Slabs belong to lanes, one per JobTable shard; a lane's slabs are placed on its
+ *   NUMA node, and a released slot goes back to the lane it came from.<br>
+ * - Each slot has a generation counter, odd while a job lives there.<br>
+ * - acquire and release are called by Mom only; get may be called by any thread.<br>
+ * - The destructor destroys every live job and frees every slab.<br>
+ */
+class JobPool {
+private:
+    static const uint32_t slabJobs = 4096;       ///< Jobs per slab
+    static const uint32_t maxSlabs = 1 << 16;    ///< Slab directory size (268M jobs)
+
+    /** One slab: raw storage for the jobs plus their generation counters */
+    struct Slab {
+        alignas(Job) unsigned char storage[slabJobs][sizeof(Job)];
+        atomic<uint32_t> generation[slabJobs]{};
+
+        Job* job(uint32_t i) { return reinterpret_cast<Job*>(storage[i]); }
+    };
+
+    /** Slabs and free slots of one NUMA node */
+    struct Lane {
+        int node = -1;                           ///< Node its slabs are placed on, -1 for no preference
+        uint32_t nextFresh = 0;                  ///< First never-used slot of its newest slab
+        uint32_t freshEnd = 0;                   ///< End of its newest slab
+        vector<uint32_t> freeList;               ///< Released slot indexes
+    };
+
+    unique_ptr<atomic<Slab*>[]> slabs;           ///< Slab directory, filled as the pool grows
+    uint32_t slabCount = 0;                      ///< Number of slabs allocated
+    vector<uint16_t> slabLane;                   ///< Lane each slab belongs to
+    vector<Lane> lanes;                          ///< One lane, or one per JobTable shard
+    size_t live = 0;                             ///< Jobs currently acquired
+
+    /** Finds a free slot, growing the pool if needed<br>
+     * @param lane Lane to take it from
+     * @return Slot index
+     */
+    uint32_t takeSlot(int lane);
+
+    /** Marks a slot whose Job was just constructed as live<br>
+     * @param index Slot index from takeSlot
+     * @return Handle to the job
+     */
+    JobHandle publish(uint32_t index);
+
+public:
+    /** Constructor: allocates the (empty) slab directory */
+    JobPool();
+
+    /** Destructor: destroys live jobs and frees all slabs */
+    ~JobPool();
+
+    JobPool(const JobPool&) = delete;
+    JobPool& operator=(const JobPool&) = delete;
+
+    /** Sets one lane per NUMA node given<br>
+     * Must be called before the first acquire.<br>
+     * @param nodes Node of each lane, -1 for no preference
+     */
+    void setLanes(const vector<int>& nodes);
+
+    /** Constructs a new Job in a free slot of a lane<br>
+     * @param lane Lane index, see setLanes
+     * @param args Job constructor arguments: none for a random job, or its ratings
+     * @return Handle to the new job
+     */
+    template <class... Args>
+    JobHandle acquireOn(int lane, Args&&... args) {
+        uint32_t index = takeSlot(lane);
+        new (slabs[index / slabJobs].load(memory_order_relaxed)->job(index % slabJobs)) Job(std::forward<Args>(args)...);
+        return publish(index);
+    }
+
+    /** Constructs a new Job in a free slot of the first lane<br>
+     * @param args Job constructor arguments: none for a random job, or its ratings
+     * @return Handle to the new job
+     */
+    template <class... Args>
+    JobHandle acquire(Args&&... args) {
+        return acquireOn(0, std::forward<Args>(args)...);
+    }
+
+    /** Destroys a job and returns its slot to the free list<br>
+     * Stale handles are ignored.<br>
+     * @param handle Job to release
+     */
+    void release(JobHandle handle);
+
+    /** Resolves a handle<br>
+     * @param handle Handle to look up<br>
+     * @return The job, or nullptr if the handle is invalid or stale
+     */
+    Job* get(JobHandle handle) const {
+        if (!handle.valid()) return nullptr;
+        Slab* slab = slabs[handle.index / slabJobs].load(memory_order_acquire);
+        uint32_t i = handle.index % slabJobs;
+        if (slab == nullptr || slab->generation[i].load(memory_order_acquire) != handle.generation) return nullptr;
+        return slab->job(i);
+    }
+
+    /** Number of jobs currently acquired */
+    size_t size() const { return live; }
+};
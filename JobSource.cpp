@@ -0,0 +1,238 @@
+#include "JobSource.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+
+/** Jobs the reader parses between two visits to the ring */
+static const size_t readerBatch = 256;
+
+/** Constructor: initializes the lock and condition variables */
+JobSource::JobSource() {
+    pthread_mutex_init(&lock, nullptr);
+    pthread_cond_init(&notFull, nullptr);
+    pthread_cond_init(&notEmpty, nullptr);
+}
+
+/** Destructor: stops the reader if close() was never called */
+JobSource::~JobSource() {
+    close();
+    pthread_cond_destroy(&notEmpty);
+    pthread_cond_destroy(&notFull);
+    pthread_mutex_destroy(&lock);
+}
+
+/**
+ * Opens the input<br>
+ * --------------------------------------------------
+ * - Maps the whole file read-only; nothing is read until the reader touches it.
+ * - MADV_SEQUENTIAL lets the kernel read ahead aggressively and reclaim early.
+ * @param file Input path
+ * @param jobs Ring capacity
+ * @return true on success
+ */
+bool JobSource::open(const string& file, size_t jobs) {
+    path = file;
+    fd = ::open(path.c_str(), O_RDONLY);
+    struct stat info{};
+    if (fd < 0 || fstat(fd, &info) != 0) return false;
+    bytes = static_cast<size_t>(info.st_size);
+    if (bytes > 0) {
+        void* mapped = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) return false;
+        data = static_cast<const char*>(mapped);
+        madvise(mapped, bytes, MADV_SEQUENTIAL);
+    }
+
+    JobFileHeader header{};
+    if (bytes >= sizeof(header)) memcpy(&header, data, sizeof(header));
+    binary = memcmp(header.magic, "TDJOBS01", 8) == 0;
+    if (binary && (header.version != 1 || header.recordSize != sizeof(JobFileRecord))) return false;
+    offset = binary ? sizeof(header) : 0;
+
+    capacity = max<size_t>(jobs, 1);
+    ring.assign(3 * capacity, 0);
+    pthread_create(&reader, nullptr, readerMain, this);
+    running = true;
+    return true;
+}
+
+/** pthread entry point */
+void* JobSource::readerMain(void* arg) {
+    static_cast<JobSource*>(arg)->readLoop();
+    return nullptr;
+}
+
+/**
+ * Reader loop<br>
+ * --------------------------------------------------
+ * - Parses a batch with the lock released, then copies it into the ring,
+ *   waiting on notFull whenever the ring fills up.
+ * - Sets finished on the way out, so take() stops waiting.
+ */
+void JobSource::readLoop() {
+    vector<uint8_t> batch;
+    batch.reserve(3 * readerBatch);
+    uint8_t job[3];
+    bool more = true;
+    while (more) {
+        batch.clear();
+        while (batch.size() < 3 * readerBatch && (more = parse(job))) batch.insert(batch.end(), job, job + 3);
+        advise();
+
+        pthread_mutex_lock(&lock);
+        size_t parsed = batch.size() / 3;
+        size_t k = 0;
+        while (k < parsed && !stopping) {
+            if (count == capacity) {
+                readerBlocks++;
+                while (count == capacity && !stopping) pthread_cond_wait(&notFull, &lock);
+                continue;
+            }
+            for (; k < parsed && count < capacity; k++, count++) {
+                memcpy(&ring[3 * ((head + count) % capacity)], &batch[3 * k], 3);
+            }
+            pthread_cond_signal(&notEmpty);
+        }
+        jobsRead += static_cast<long>(k);
+        if (stopping) more = false;
+        if (!more) {
+            finished = true;
+            pthread_cond_broadcast(&notEmpty);
+        }
+        pthread_mutex_unlock(&lock);
+    }
+}
+
+/**
+ * Parses one job<br>
+ * --------------------------------------------------
+ * - Binary: the next 4-byte record.
+ * - CSV: the next line holding three comma-separated ratings; blank lines,
+ *   lines starting with # and a first line that does not start with a digit
+ *   (a column header) are skipped.
+ * - A rating outside 1 to 5 or a malformed line exits through fatal().
+ * @param job Receives the ratings
+ * @return false at the end of the input
+ */
+bool JobSource::parse(uint8_t job[3]) {
+    if (binary) {
+        if (bytes - offset < sizeof(JobFileRecord)) return false;
+        memcpy(job, data + offset, 3);
+        offset += sizeof(JobFileRecord);
+        for (int r = 0; r < 3; r++) {
+            if (job[r] < 1 || job[r] > 5) fatal(path + ": job " + to_string((offset - sizeof(JobFileHeader)) / sizeof(JobFileRecord)) + " has a rating outside 1 to 5");
+        }
+        return true;
+    }
+
+    const char* end = data + bytes;
+    while (offset < bytes) {
+        const char* p = data + offset;
+        const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (eol == nullptr) eol = end;
+        offset = static_cast<size_t>(eol - data) + (eol < end ? 1 : 0);
+        long at = line++;
+        const char* stop = eol > p && eol[-1] == '\r' ? eol - 1 : eol;
+        while (p < stop && (*p == ' ' || *p == '\t')) p++;
+        if (p == stop || *p == '#' || (at == 1 && !isdigit(static_cast<unsigned char>(*p)))) continue;
+
+        for (int field = 0; field < 3; field++) {
+            while (p < stop && (*p == ' ' || *p == '\t')) p++;
+            if (p == stop || *p < '1' || *p > '5') fatal(path + " line " + to_string(at) + ": expected slow,dirty,heavy, each 1 to 5");
+            job[field] = static_cast<uint8_t>(*p++ - '0');
+            while (p < stop && (*p == ' ' || *p == '\t')) p++;
+            if (field < 2 && (p == stop || *p++ != ',')) fatal(path + " line " + to_string(at) + ": expected slow,dirty,heavy, each 1 to 5");
+        }
+        if (p != stop) fatal(path + " line " + to_string(at) + ": expected slow,dirty,heavy, each 1 to 5");
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Read-ahead and release<br>
+ * --------------------------------------------------
+ * - Keeps MADV_WILLNEED one window ahead of the reader.
+ * - Drops whole windows behind it with MADV_DONTNEED; the mapping is
+ *   read-only, so the pages are simply read again if ever touched.
+ */
+void JobSource::advise() {
+    if (data == nullptr) return;
+    char* base = const_cast<char*>(data);
+    while (advisedTo < bytes && advisedTo < offset + window) {
+        madvise(base + advisedTo, min(window, bytes - advisedTo), MADV_WILLNEED);
+        advisedTo += window;
+    }
+    if (offset >= releasedTo + 2 * window) {
+        size_t upTo = (offset - window) / window * window;
+        madvise(base + releasedTo, upTo - releasedTo, MADV_DONTNEED);
+        releasedTo = upTo;
+    }
+}
+
+/**
+ * Hands jobs to Mom<br>
+ * --------------------------------------------------
+ * - Waits only while the ring is empty and the reader has not finished.
+ * @param ratings Receives three ratings per job
+ * @param jobs Jobs wanted
+ * @return Jobs taken
+ */
+size_t JobSource::take(uint8_t* ratings, size_t jobs) {
+    pthread_mutex_lock(&lock);
+    size_t got = 0;
+    while (got < jobs) {
+        if (count == 0) {
+            if (finished) break;
+            momWaits++;
+            while (count == 0 && !finished) pthread_cond_wait(&notEmpty, &lock);
+            continue;
+        }
+        for (; got < jobs && count > 0; got++, count--) {
+            memcpy(ratings + 3 * got, &ring[3 * head], 3);
+            head = (head + 1) % capacity;
+        }
+        pthread_cond_signal(&notFull);
+    }
+    jobsTaken += static_cast<long>(got);
+    pthread_mutex_unlock(&lock);
+    return got;
+}
+
+/** @return true once the reader has finished and the ring is empty */
+bool JobSource::exhausted() {
+    pthread_mutex_lock(&lock);
+    bool done = finished && count == 0;
+    pthread_mutex_unlock(&lock);
+    return done;
+}
+
+/** Stops and joins the reader, then unmaps and closes the input */
+void JobSource::close() {
+    if (running) {
+        pthread_mutex_lock(&lock);
+        stopping = true;
+        pthread_cond_broadcast(&notFull);
+        pthread_mutex_unlock(&lock);
+        pthread_join(reader, nullptr);
+        running = false;
+    }
+    if (data != nullptr) {
+        munmap(const_cast<char*>(data), bytes);
+        data = nullptr;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+/**
+ * Prints the input's numbers<br>
+ * --------------------------------------------------
+ * @param out Stream to format into
+ */
+void JobSource::print(ostream& out) const {
+    out << "Input: " << jobsTaken << " of " << jobsRead << " jobs read from " << path << " (" << (binary ? "job file" : "CSV")
+        << ") were posted; the reader waited on a full table " << readerBlocks << " times, Mom waited on the reader "
+        << momWaits << " times";
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include "tools.hpp"
+#include <cstdint>
+
+/**
+ * JobFileHeader struct<br>
+ * ------------------------------------------------------<br>
+ * - Start of a binary job file; JobFileRecords follow back to back.<br>
+ * - eventdump --jobs writes one from a binary event log, so a recorded run can be replayed.<br>
+ */
+struct JobFileHeader {
+    char magic[8];         ///< "TDJOBS01"
+    uint32_t version;      ///< Format version, currently 1
+    uint32_t recordSize;   ///< sizeof(JobFileRecord)
+};
+static_assert(sizeof(JobFileHeader) == 16, "JobFileHeader must stay 16 bytes");
+
+/** One job of a binary job file */
+struct JobFileRecord {
+    uint8_t slow;          ///< Slow rating, 1 to 5
+    uint8_t dirty;         ///< Dirty rating, 1 to 5
+    uint8_t heavy;         ///< Heavy rating, 1 to 5
+    uint8_t reserved;      ///< Zero
+};
+static_assert(sizeof(JobFileRecord) == 4, "JobFileRecord must stay 4 bytes");
+
+/**
+ * JobSource class<br>
+ * ------------------------------------------------------<br>
+ * - Streams recorded jobs into the table instead of rolling random ones.<br>
+ * - The input is memory-mapped read-only, either a binary job file or CSV lines of
+ *   slow,dirty,heavy; a reader thread parses it into a ring of ratings.<br>
+ * - The ring holds one table's worth of jobs. When it is full the reader blocks
+ *   until Mom frees slots and takes more, so memory does not grow with the file.<br>
+ * - The mapping is read sequentially: the kernel is asked to read one window
+ *   ahead, and pages behind the reader are dropped, so only a few windows of a
+ *   file of any size are resident.<br>
+ */
+class JobSource {
+private:
+    string path;
+    int fd = -1;
+    const char* data = nullptr;       ///< Mapped input
+    size_t bytes = 0;                 ///< Input size
+    bool binary = false;              ///< Job file rather than CSV
+    size_t offset = 0;                ///< Reader's position in the input
+    size_t advisedTo = 0;             ///< End of the range passed to MADV_WILLNEED
+    size_t releasedTo = 0;            ///< End of the range passed to MADV_DONTNEED
+    long line = 1;                    ///< CSV line at offset, for error messages
+    pthread_t reader{};
+    bool running = false;             ///< True while the reader thread runs
+    pthread_mutex_t lock{};
+    pthread_cond_t notFull{};         ///< Signalled when Mom takes jobs
+    pthread_cond_t notEmpty{};        ///< Signalled when the reader adds jobs or reaches the end
+    vector<uint8_t> ring;             ///< Three ratings per job
+    size_t capacity = 0;              ///< Jobs the ring holds
+    size_t head = 0;                  ///< Oldest job in the ring
+    size_t count = 0;                 ///< Jobs in the ring
+    bool finished = false;            ///< The reader reached the end of the input
+    bool stopping = false;
+    long jobsRead = 0;                ///< Jobs parsed
+    long jobsTaken = 0;               ///< Jobs handed to Mom
+    long readerBlocks = 0;            ///< Times the reader found the ring full
+    long momWaits = 0;                ///< Times Mom found the ring empty
+
+    /** Reader loop: parses jobs into the ring until the input ends or close() */
+    void readLoop();
+
+    /** Parses the job at offset<br>
+     * @param job Receives slow, dirty and heavy
+     * @return false at the end of the input
+     */
+    bool parse(uint8_t job[3]);
+
+    /** Moves the read-ahead window and drops the pages behind offset */
+    void advise();
+
+    static void* readerMain(void* arg);
+
+public:
+    static constexpr size_t window = 8 << 20;   ///< Bytes read ahead and released at a time
+
+    JobSource();
+    ~JobSource();
+
+    JobSource(const JobSource&) = delete;
+    JobSource& operator=(const JobSource&) = delete;
+
+    /** Maps an input file and starts the reader<br>
+     * A file starting with the job file magic is read as binary, anything else as CSV.
+     * @param file Input path
+     * @param jobs Ring capacity in jobs, normally Config::tableSize
+     * @return false if the file cannot be opened or mapped
+     */
+    bool open(const string& file, size_t jobs);
+
+    /** Takes up to count jobs, waiting for the reader while the ring is empty<br>
+     * @param ratings Receives three ratings per job
+     * @param jobs Jobs wanted
+     * @return Jobs taken; fewer than wanted only once the input is used up
+     */
+    size_t take(uint8_t* ratings, size_t jobs);
+
+    /** True once every job of the input has been taken */
+    bool exhausted();
+
+    /** Stops the reader and unmaps the input */
+    void close();
+
+    /** Prints jobs read, the format, and how often either side waited */
+    void print(ostream& out) const;
+};
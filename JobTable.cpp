@@ -0,0 +1,239 @@
+#include "JobTable.hpp"
+#include "KidScheduler.hpp"
+
+/**
+ * Splits the table<br>
+ * --------------------------------------------------
+ * - Slots are divided into equal contiguous ranges, the last one shorter
+ *   when the table size is not a multiple of the shard count.
+ * - Each shard gets the JobPool lane of the same index, on the shard's node.
+ * @param nodes Node of each shard
+ */
+void JobTable::split(const vector<int>& nodes) {
+    shards.clear();
+    for (int node : nodes) {
+        shards.push_back(make_unique<Shard>());
+        shards.back()->node = node;
+    }
+    shardSlots = max<int>(1, (static_cast<int>(jobs.size()) + static_cast<int>(nodes.size()) - 1) / static_cast<int>(nodes.size()));
+    pool.setLanes(nodes);
+}
+
+/**
+ * Posts a slot according to the scheduling mode<br>
+ * --------------------------------------------------
+ * - SCAN mode copies the job into the columns and wakes scanning kids.
+ * @param slot Index of the slot that was just filled
+ */
+void JobTable::post(int slot) {
+    at(slot)->jobNumber = slot;
+    if (mode == SchedMode::STEAL) {
+        distribute(slot);
+    } else if (mode == SchedMode::SCAN) {
+        columns.store(slot, *at(slot));
+        postCount.fetch_add(1, memory_order_release);
+        pthread_cond_broadcast(&postedCond);
+    } else {
+        publish(slot);
+    }
+}
+
+/**
+ * Posts a newly ready job<br>
+ * --------------------------------------------------
+ * - Called by the kid that completed the job's last predecessor, holding no lock.
+ * @param slot Slot of the job
+ */
+void JobTable::postReady(int slot) {
+    Shard& shard = shardOf(slot);
+    pthread_mutex_lock(&shard.lock);
+    at(slot)->postedAt = now();
+    post(slot);
+    pthread_mutex_unlock(&shard.lock);
+}
+
+/**
+ * Returns a reserved job<br>
+ * --------------------------------------------------
+ * - Ignored if the slot has been refilled since, which cannot happen
+ *   while the job is reserved, or if the job was started.
+ * @param handle Handle of the job, whose jobNumber is its slot
+ */
+void JobTable::giveBack(JobHandle handle) {
+    Job* job = pool.get(handle);
+    if (job == nullptr || jobs[job->jobNumber] != handle || job->status != JobStatus::WORKING) return;
+    job->status = JobStatus::NOT_STARTED;
+    job->kidId = -1;
+    post(job->jobNumber);
+}
+
+/**
+ * Posts a slot to the ready buckets<br>
+ * --------------------------------------------------
+ * - A job is pushed to each strategy bucket of its shard whose filter it passes,
+ *   if some kid claims with that strategy; stale entries are only dropped by
+ *   claims, so an unclaimed bucket would grow for the whole run.
+ * - The COOPERATIVE bucket receives every job.
+ * - In PRIORITY mode the job goes on the strategy heaps instead, in O(log n).
+ * - One kid parked on each receiving bucket is woken, thread or coroutine.
+ * @param slot Index of the slot that was just filled
+ */
+void JobTable::publish(int slot) {
+    Job* job = at(slot);
+    Shard& shard = shardOf(slot);
+    for (size_t s = 0; s < shard.ready.size(); s++) {
+        if (claimers[s] > 0 && StrategyRegistry::get(static_cast<int>(s)).eligible(*job)) {
+            if (mode == SchedMode::PRIORITY) {
+                shard.ranked[s].push_back({job->value - aging * job->postedAt, slot, jobs[slot]});
+                push_heap(shard.ranked[s].begin(), shard.ranked[s].end());
+            } else {
+                shard.ready[s].push_back({slot, jobs[slot]});
+            }
+            pthread_cond_signal(&shard.readyCond[s]);
+            unpark(shard, static_cast<int>(s));
+        }
+    }
+}
+
+/**
+ * Claims a job from a ready bucket<br>
+ * --------------------------------------------------
+ * - Entries whose slot was refilled or whose job was already taken
+ *   through another bucket are discarded.
+ * - Each entry is popped at most once, so a claim is amortized O(1),
+ *   or O(log n) from a PRIORITY heap.
+ * @param shard Shard to pop from
+ * @param strategy Bucket to pop from
+ * @param slot Receives the slot index of the claimed job
+ * @return The job, or nullptr when nothing eligible is waiting
+ */
+Job* JobTable::claim(Shard& shard, int strategy, int& slot) {
+    if (!hasReady(shard, strategy)) return nullptr;
+    if (mode == SchedMode::PRIORITY) {
+        vector<RankedEntry>& heap = shard.ranked[strategy];
+        pop_heap(heap.begin(), heap.end());
+        RankedEntry entry = heap.back();
+        heap.pop_back();
+        slot = entry.slot;
+        return pool.get(entry.job);
+    }
+    deque<ReadyEntry>& bucket = shard.ready[strategy];
+    ReadyEntry entry = bucket.front();
+    bucket.pop_front();
+    slot = entry.slot;
+    return pool.get(entry.job);
+}
+
+/**
+ * Peeks at a ready bucket<br>
+ * --------------------------------------------------
+ * - Drops stale entries from the front, or the top of the heap, until a live one is found.
+ * @param shard Shard to inspect
+ * @param strategy Bucket to inspect
+ * @return true if the front entry is claimable
+ */
+bool JobTable::hasReady(Shard& shard, int strategy) {
+    if (mode == SchedMode::PRIORITY) {
+        vector<RankedEntry>& heap = shard.ranked[strategy];
+        while (!heap.empty()) {
+            const RankedEntry& entry = heap.front();
+            if (jobs[entry.slot] == entry.job && pool.get(entry.job)->status == JobStatus::NOT_STARTED) return true;
+            pop_heap(heap.begin(), heap.end());
+            heap.pop_back();
+        }
+        return false;
+    }
+    deque<ReadyEntry>& bucket = shard.ready[strategy];
+    while (!bucket.empty()) {
+        const ReadyEntry& entry = bucket.front();
+        if (jobs[entry.slot] == entry.job && pool.get(entry.job)->status == JobStatus::NOT_STARTED) return true;
+        bucket.pop_front();
+    }
+    return false;
+}
+
+/**
+ * Round-robin distribution to kid deques<br>
+ * --------------------------------------------------
+ * - Starts at the cursor and skips kids whose strategy rejects the job,
+ *   so a kid's own deque only ever holds jobs it will do.
+ * - The job goes into the kid's inbox and the kid is woken.
+ * @param slot Index of the slot that was just filled
+ */
+void JobTable::distribute(int slot) {
+    Job* job = at(slot);
+    for (size_t tries = 0; tries < queues.size(); tries++) {
+        KidQueue& queue = *queues[nextQueue];
+        nextQueue = (nextQueue + 1) % queues.size();
+        if (!StrategyRegistry::get(queue.strategy).eligible(*job)) continue;
+        pthread_mutex_lock(&queue.lock);
+        queue.inbox.push_back(jobs[slot]);
+        pthread_cond_signal(&queue.cond);
+        pthread_mutex_unlock(&queue.lock);
+        return;
+    }
+}
+
+/**
+ * Checks a job against the kids' strategies<br>
+ * --------------------------------------------------
+ * - A job no registered strategy takes stays on the table for the whole run.
+ * @param job Job to check
+ * @return true if some kid would claim it
+ */
+bool JobTable::claimable(const Job& job) const {
+    for (size_t s = 0; s < claimers.size(); s++) {
+        if (claimers[s] > 0 && StrategyRegistry::get(static_cast<int>(s)).eligible(job)) return true;
+    }
+    return false;
+}
+
+/**
+ * Registers a kid queue<br>
+ * --------------------------------------------------
+ * @param strategy Strategy the kid will keep for the whole run
+ * @return Queue index
+ */
+int JobTable::addQueue(int strategy) {
+    queues.push_back(make_unique<KidQueue>(strategy));
+    return static_cast<int>(queues.size()) - 1;
+}
+
+/**
+ * Unparks a coroutine kid<br>
+ * --------------------------------------------------
+ * - The most recently parked kid goes first; its frame is the likeliest to still be cached.
+ * @param shard Shard the bucket belongs to
+ * @param strategy Bucket that received a job
+ */
+void JobTable::unpark(Shard& shard, int strategy) {
+    vector<coroutine_handle<>>& waiting = shard.parked[strategy];
+    if (waiting.empty()) return;
+    scheduler->schedule(waiting.back());
+    waiting.pop_back();
+}
+
+/**
+ * Wakes all parked kids<br>
+ * --------------------------------------------------
+ * - Broadcasts every bucket of every shard, the SCAN condition and every kid queue
+ *   so kids re-check quitFlag and leave.
+ * - Every parked coroutine kid is handed back to the scheduler.
+ * - Each broadcast is made under the lock its waiters hold while checking, so none is missed.
+ */
+void JobTable::wakeAll() {
+    for (unique_ptr<Shard>& shard : shards) {
+        pthread_mutex_lock(&shard->lock);
+        for (size_t s = 0; s < shard->parked.size(); s++) {
+            while (!shard->parked[s].empty()) unpark(*shard, static_cast<int>(s));
+        }
+        for (pthread_cond_t& cond : shard->readyCond) pthread_cond_broadcast(&cond);
+        if (shard == shards.front()) pthread_cond_broadcast(&postedCond);
+        pthread_mutex_unlock(&shard->lock);
+    }
+    for (unique_ptr<KidQueue>& queue : queues) {
+        pthread_mutex_lock(&queue->lock);
+        pthread_cond_broadcast(&queue->cond);
+        pthread_mutex_unlock(&queue->lock);
+    }
+}
@@ -1,36 +1,260 @@
 #pragma once
 #include "tools.hpp"
 #include "Job.hpp"
+#include "JobPool.hpp"
+#include "JobColumns.hpp"
+#include "StealDeque.hpp"
+#include "SelectionPolicy.hpp"
+#include "Leaderboard.hpp"
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <deque>
+#include <memory>
+#include <semaphore.h>
+
+class KidScheduler;
 
 /**
  * JobTable class<br>
  * ------------------------------------------------------<br>
- * - Holds an array of pointers to 10 Job objects.<br>
- * - Includes a pthread mutex for safe concurrent access.<br>
+ * - Holds a runtime-sized array of handles to Job objects owned by its JobPool.<br>
+ * - Split into shards, each a contiguous range of slots with its own mutex,
+ *   ready buckets and completed-slot list; one shard unless --shards asks for more.<br>
+ * - Shard jobs come from the shard's JobPool lane, placed on the shard's NUMA node.<br>
  * - Contains a quitFlag used to signal when job selection should stop.<br>
- * - The constructor initializes the mutex.<br>
- * - The destructor destroys the mutex to prevent leaks.<br>
+ * - Keeps one ready bucket per selection strategy so a kid can pop an eligible job in O(1).<br>
+ * - A kid may pop several jobs per lock (Config::batch) and return the unstarted ones.<br>
+ * - Kids park on a bucket's condition variable until a matching job is posted;
+ *   coroutine kids park their handle on the bucket and are handed to the KidScheduler.<br>
+ * - Completed slots are queued on their shard for Mom, who is woken through the done semaphore.<br>
+ * - Completed jobs are credited to their kid on a lock-free Leaderboard.<br>
+ * - In STEAL mode jobs bypass the buckets and go round-robin to per-kid deques.<br>
+ * - In SCAN mode kids scan packed attribute columns with a SIMD kernel
+ *   and claim a slot with a CAS on its status byte.<br>
+ * - In PRIORITY mode each bucket is a binary heap ordered by aged value, so a
+ *   claim pops the best eligible job in O(log n).<br>
+ * - The constructor initializes the mutex and condition variables.<br>
+ * - The destructor destroys them to prevent leaks.<br>
  * - Used and accessed by Mom and Kid classes.<br>
  */
 class JobTable {
 private:
-  Job* jobs[10]{};                 ///< Array of pointers to Job objects
-  pthread_mutex_t lock{};         ///< Mutex for synchronizing access to the table
-  bool quitFlag;                  ///< Flag to indicate whether kids should continue working
+  /** One entry of a ready bucket: the slot a job was posted to and the job itself.<br>
+   * An entry is stale once the slot holds another job or the job is no longer NOT_STARTED.
+   */
+  struct ReadyEntry {
+    int slot;
+    JobHandle job;
+  };
+
+  /** One entry of a priority heap, used in PRIORITY mode.<br>
+   * A job waiting t seconds ranks as value + aging * t. Every waiting job ages at
+   * the same rate, so ranking by value - aging * postedAt gives the same order
+   * at any moment and the key never has to change once pushed.<br>
+   * Ties go to the lower slot. Stale entries are dropped lazily, as in the buckets.
+   */
+  struct RankedEntry {
+    double key;
+    int slot;
+    JobHandle job;
+
+    bool operator<(const RankedEntry& other) const {
+      return key < other.key || (key == other.key && slot > other.slot);
+    }
+  };
+
+  /** Per-kid work queue used in STEAL mode.<br>
+   * Mom appends to the inbox under the queue's own lock; the kid moves
+   * the inbox into its deque, pops from the bottom, and others steal from the top.
+   */
+  struct KidQueue {
+    StealDeque<JobHandle> deque;   ///< Owned by the kid, stolen from by the others
+    vector<JobHandle> inbox;       ///< Jobs Mom handed over since the last drain
+    vector<JobHandle> drained;     ///< Kid-only scratch space for draining the inbox
+    int strategy;                  ///< Strategy of the owning kid, used for routing
+    pthread_mutex_t lock{};        ///< Guards inbox and the parking condition
+    pthread_cond_t cond{};         ///< Signalled when the inbox gets a job
+
+    explicit KidQueue(int strategy): strategy(strategy) {
+      pthread_mutex_init(&lock, nullptr);
+      pthread_cond_init(&cond, nullptr);
+    }
+    ~KidQueue() {
+      pthread_cond_destroy(&cond);
+      pthread_mutex_destroy(&lock);
+    }
+  };
+
+  /** One shard: a contiguous range of slots and everything claims on them lock.<br>
+   * Kids take the lock of their home shard, and of another shard only when theirs
+   * has nothing for them; with shards on different sockets the locks and buckets
+   * stay in their socket's caches. Cache-line aligned so two shards never share a line.
+   */
+  struct alignas(64) Shard {
+    pthread_mutex_t lock{};                     ///< Guards the buckets, heaps and doneSlots below
+    vector<deque<ReadyEntry>> ready;            ///< Ready buckets indexed by StrategyRegistry index
+    vector<vector<RankedEntry>> ranked;         ///< Max-heaps by aged value, per strategy, only used in PRIORITY mode
+    vector<pthread_cond_t> readyCond;           ///< Signalled when a job lands in the matching bucket
+    vector<vector<coroutine_handle<>>> parked;  ///< Coroutine kids waiting on each bucket
+    vector<int> doneSlots;                      ///< Completed slots waiting for Mom to refill
+    int node = -1;                              ///< NUMA node its jobs are placed on, -1 for no preference
+
+    Shard(): ready(StrategyRegistry::count()), ranked(StrategyRegistry::count()),
+             readyCond(StrategyRegistry::count()), parked(StrategyRegistry::count()) {
+      pthread_mutex_init(&lock, nullptr);
+      for (pthread_cond_t& cond : readyCond) pthread_cond_init(&cond, nullptr);
+    }
+    ~Shard() {
+      for (pthread_cond_t& cond : readyCond) pthread_cond_destroy(&cond);
+      pthread_mutex_destroy(&lock);
+    }
+  };
+
+  static constexpr long remoteRecheckMicros = 1000;  ///< Longest a kid parks on its home shard before checking the others
+
+  JobPool pool;                    ///< Owns every Job the table has ever held
+  vector<JobHandle> jobs;          ///< One handle per slot, sized by Mom from Config
+  JobColumns columns;              ///< Packed per-slot attributes, only used in SCAN mode
+  vector<unique_ptr<Shard>> shards; ///< Shard s holds slots [s * shardSlots, (s + 1) * shardSlots)
+  int shardSlots = INT32_MAX;     ///< Slots per shard, the last shard may have fewer
+  double aging = 0;               ///< Value a waiting job gains per second in PRIORITY mode
+  KidScheduler* scheduler = nullptr;  ///< Runs coroutine kids, null when kids are threads
+  sem_t done{};                   ///< Posted once per completed slot, waited on by Mom
+  atomic<bool> quitFlag;          ///< Flag to indicate whether kids should continue working
+  SchedMode mode = SchedMode::SHARED;  ///< Whether kids claim from buckets or their own deques
+  int batch = 1;                  ///< Claim budget per lock in SHARED mode, in units of Job::slow
+  long tick = 1000000;            ///< Microseconds a kid sleeps per unit of Job::slow
+  bool quiet = false;             ///< Skips per-job text, set by --quiet and for virtual-clock runs
+  Leaderboard scores;             ///< Per-kid earnings, credited as jobs complete
+  vector<unique_ptr<KidQueue>> queues; ///< One queue per kid, only used in STEAL mode
+  vector<int> claimers = vector<int>(StrategyRegistry::count()); ///< Kids with each strategy, in every mode
+  size_t nextQueue = 0;           ///< Round-robin cursor for distribute()
+  atomic<uint64_t> postCount{0};  ///< Jobs posted so far, lets SCAN kids park without missing one
+  pthread_cond_t postedCond{};    ///< Broadcast on every post in SCAN mode, paired with shard 0's lock
+  chrono::steady_clock::time_point startedAt = chrono::steady_clock::now(); ///< Time zero of a real-time run
+  bool simulated = false;         ///< True while Mom runs the virtual clock
+  double simulatedNow = 0;        ///< Current simulated second, set by Mom on the virtual clock
+
+  /** Returns seconds into the run: real time since startedAt, or the simulated clock */
+  double now() const {
+    return simulated ? simulatedNow : chrono::duration<double>(chrono::steady_clock::now() - startedAt).count();
+  }
+
+  /** Returns the shard a slot belongs to */
+  Shard& shardOf(int slot) const { return *shards[slot / shardSlots]; }
+
+  /** Splits the table into shards, one JobPool lane each.<br>
+   * Must be called after jobs is sized and before any job is posted.<br>
+   * @param nodes NUMA node of each shard, -1 for no preference
+   */
+  void split(const vector<int>& nodes);
+
+  /** Makes a freshly filled slot claimable, through publish() or distribute().<br>
+   * Caller must hold the slot's shard lock.<br>
+   * @param slot Index of the freshly filled slot
+   */
+  void post(int slot);
+
+  /** Posts a job whose last predecessor just completed.<br>
+   * Takes the slot's shard lock and restarts the job's wait clock, since it
+   * could not be claimed before now.<br>
+   * @param slot Slot the job was put in when Mom created it
+   */
+  void postReady(int slot);
+
+  /** Returns a job a kid reserved but never started.<br>
+   * The job is reset to NOT_STARTED and posted again.<br>
+   * Caller must hold the lock of the job's shard.<br>
+   * @param handle Handle of the reserved job
+   */
+  void giveBack(JobHandle handle);
+
+  /** Posts the job in a slot to every bucket, or heap in PRIORITY mode, of its shard whose strategy would accept it.<br>
+   * Buckets of strategies no kid has are skipped, since nothing would ever drain them.<br>
+   * Caller must hold the slot's shard lock.<br>
+   * @param slot Index of the freshly filled slot
+   */
+  void publish(int slot);
+
+  /** Pops the first live entry of a strategy's bucket, dropping stale ones on the way.<br>
+   * In PRIORITY mode the bucket is the strategy's heap and the entry its top.<br>
+   * Caller must hold the shard's lock.<br>
+   * @param shard Shard to claim from<br>
+   * @param strategy Bucket to pop from<br>
+   * @param slot Set to the slot index of the returned job<br>
+   * @return The claimable job, or nullptr if the bucket is empty
+   */
+  Job* claim(Shard& shard, int strategy, int& slot);
+
+  /** Resolves the handle in a slot<br>
+   * @param slot Slot index<br>
+   * @return The job in that slot
+   */
+  Job* at(int slot) const { return pool.get(jobs[slot]); }
+
+  /** Hands the job in a slot to the next kid, in round-robin order, whose strategy accepts it.<br>
+   * Jobs no kid would take stay on the table unassigned.<br>
+   * Caller must hold shard 0's lock.<br>
+   * @param slot Index of the freshly filled slot
+   */
+  void distribute(int slot);
+
+  /** Registers a kid's queue for STEAL mode.<br>
+   * @param strategy Strategy of the kid, fixed for the run<br>
+   * @return Index of the queue, which is also the kid's id
+   */
+  int addQueue(int strategy);
+
+  /** Registers a kid's strategy, in every mode.<br>
+   * SHARED and PRIORITY mode only fill the buckets of registered strategies.<br>
+   * @param strategy Strategy of the kid, fixed for the run
+   */
+  void addClaimer(int strategy) { claimers[strategy]++; }
+
+  /** Checks whether any kid would ever take a job.<br>
+   * @param job Job to check<br>
+   * @return true if the job passes the filter of some registered strategy
+   */
+  bool claimable(const Job& job) const;
+
+  /** Checks whether a bucket still holds a claimable job, dropping stale entries.<br>
+   * Caller must hold the shard's lock.<br>
+   * @param shard Shard to inspect<br>
+   * @param strategy Bucket to inspect<br>
+   * @return true if the next claim on that bucket would succeed
+   */
+  bool hasReady(Shard& shard, int strategy);
+
+  /** Hands one coroutine kid parked on a bucket back to the scheduler, if any is parked.<br>
+   * Caller must hold the shard's lock.<br>
+   * @param shard Shard the bucket belongs to<br>
+   * @param strategy Bucket a job was just posted to
+   */
+  void unpark(Shard& shard, int strategy);
+
+  /** Wakes every parked kid, used when quitFlag is cleared or a stop is requested.<br>
+   * Takes each shard's lock in turn; the caller must hold none.
+   */
+  void wakeAll();
 
 public:
   /** Constructor<br>
-   * Initializes the mutex and sets quitFlag to false.
+   * Makes a single shard, initializes the semaphore and condition variable and sets quitFlag to false.<br>
+   * Each shard has one bucket and one heap per registered strategy.
    */
   JobTable(): quitFlag(false) {
-    pthread_mutex_init(&lock, nullptr);
+    shards.push_back(make_unique<Shard>());
+    sem_init(&done, 0, 0);
+    pthread_cond_init(&postedCond, nullptr);
   }
 
   /** Destructor<br>
-   * Destroys the mutex to clean up resources.
+   * Destroys the semaphore and condition variable; shards clean up their own.
    */
   ~JobTable() {
-    pthread_mutex_destroy(&lock);
+    pthread_cond_destroy(&postedCond);
+    sem_destroy(&done);
   }
 
   /** Print function placeholder<br>
@@ -41,5 +265,5 @@ public:
 
   friend class Kid;  ///< Grants access to Kid class
   friend class Mom;  ///< Grants access to Mom class
+  friend class Job;  ///< Grants access to Job class
 };
-
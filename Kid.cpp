@@ -1,85 +1,203 @@
 #include "Kid.hpp"
 #include "Printer.hpp"
+#include "EventLog.hpp"
+#include "Metrics.hpp"
+#include "Tracer.hpp"
 
 /** Kid constructor<br>
  * Creates an empty signal set and adds SIGUSR1 and SIGQUIT.<br>
  * Applies a thread-level signal mask to block signals until needed.
  * @param name Kid's name
+ * @param id Kid's index
  * @param table Pointer to shared JobTable
  */
-Kid::Kid(const string& name, JobTable* table):name(name), table(table), inProgress(nullptr){
+Kid::Kid(const string& name, int id, JobTable* table):name(name), id(id), table(table), inProgress(nullptr){
     sigemptyset(&set);
     sigaddset(&set, SIGUSR1);
     sigaddset(&set, SIGQUIT);
     pthread_sigmask(SIG_BLOCK, &set, nullptr);
 }
 
-/** Randomly selects a mood for the kid */
-void Kid::selectMood() {
-    mood = static_cast<Mood>(rand()%5);
+/** Randomly selects a strategy for the kid<br>
+ * With only the built-in strategies registered this is one of the five moods.<br>
+ * The kid's stream is seeded here, so its mood depends only on the seed and its id.
+ * @param seed Run seed
+ * @param forced Strategy from --moods, or -1 to roll one
+ */
+void Kid::selectMood(uint64_t seed, int forced) {
+    rng = Rng(seed, id + 1);
+    strategy = forced >= 0 ? forced : rng.between(0, StrategyRegistry::count() - 1);
+    mood = StrategyRegistry::get(strategy).mood;
 }
 
-/** Checks if job is suitable based on Kid's mood
- * @param job Reference to the Job object
- * @return true if job passes the mood filter, else false
+/** Records a claimed job as the kid's<br>
+ * The job is queued in reserved; run() starts it once earlier reservations are done.<br>
+ * How long the job waited since Mom posted it is added to the kid's wait totals.
+ * @param job The claimed job
+ * @param handle Pool handle of the job
+ * @param slot Slot the job was claimed from
  */
-bool Kid::moodChecker(Job& job) {
-    return (job.heavy < 3 && mood == Mood::LAZY) ||
-           (job.dirty < 3 && mood == Mood::PRISSY) ||
-           (job.slow < 3 && mood == Mood::OVERTIRED) ||
-           (job.value > 40 && mood == Mood::GREEDY);
+void Kid::takeJob(Job* job, JobHandle handle, int slot) {
+    job->chooseJob(id, slot);
+    reserved.push_back(handle);
+    claims++;
+    double waited = table->now() - job->postedAt;
+    totalWait += waited;
+    maxWait = max(maxWait, waited);
 }
 
-/** Selects task for non-cooperative kids<br>
- * Iterates through the JobTable linearly.<br>
- * Picks the first available job matching the mood filter.<br>
- * Locks mutex during selection to prevent race conditions.
+/** Takes a shard lock and counts it, so Mom can report locks per completed job
+ * @param locked Shard to lock
  */
-void Kid::non_Coop_Task_Select() {
-    int counter=-1;
-    for (Job* job: table->jobs) {
-        counter++;
-        pthread_mutex_lock(&table->lock);
-        if (job->status != JobStatus::NOT_STARTED ) {
-            pthread_mutex_unlock(&table->lock);
-            continue;
-        }
-        if (moodChecker(*job)) {
-            job->chooseJob(name, counter);
-            inProgress = job;
-            pthread_mutex_unlock(&table->lock);
-            break;
-        }
-        pthread_mutex_unlock(&table->lock);
+void Kid::lockShard(JobTable::Shard& locked) {
+    METRICS_LOCK(&locked.lock);
+    tableLocks++;
+}
+
+/** Returns reserved jobs<br>
+ * Jobs a stopped kid never started are posted again for the next run of the table,
+ * each under the lock of the shard it came from.
+ */
+void Kid::returnReserved() {
+    for (JobHandle handle : reserved) {
+        Job* job = table->pool.get(handle);
+        if (job == nullptr) continue;
+        JobTable::Shard& from = table->shardOf(job->jobNumber);
+        pthread_mutex_lock(&from.lock);
+        table->giveBack(handle);
+        pthread_mutex_unlock(&from.lock);
     }
+    reserved.clear();
 }
 
-/** Selects task for cooperative kids<br>
- * Chooses the last available job in reverse order.<br>
- * Locks mutex during access for thread safety.
+/** Selects task in SHARED and PRIORITY mode<br>
+ * Pops the ready bucket of the kid's strategy; the cooperative<br>
+ * bucket holds every posted job. Ineligible slots are never visited.<br>
+ * In PRIORITY mode the bucket is a heap and each pop is its best aged job.<br>
+ * Under one lock the kid keeps popping until the slow ratings of its jobs
+ * add up to the table's batch budget, so quick jobs come in bigger batches.<br>
+ * With several shards the home shard is tried first, then the others in
+ * turn, so a kid only pulls jobs across sockets when its own shard is empty.
  */
-void Kid::coop_Task_Select() {
-    for (int j = 9; j >= 0; j--) {
-        pthread_mutex_lock(&table->lock);
-        Job* job = table->jobs[j];
-        if (job->status != JobStatus::NOT_STARTED ) {
-            pthread_mutex_unlock(&table->lock);
-            continue;
+void Kid::bucket_Task_Select() {
+    if (claimFrom(home()) > 0) return;
+    size_t count = table->shards.size();
+    for (size_t k = 1; k < count; k++) {
+        int claimed = claimFrom(*table->shards[(shard + k) % count]);
+        if (claimed > 0) {
+            remoteClaims += claimed;
+            return;
         }
-        job->chooseJob(name, j);
-        inProgress = job;
-        pthread_mutex_unlock(&table->lock);
-        break;
     }
 }
 
-/** Job Selection wrapper based on mood<br>
- * Cooperative kids use reverse selection strategy<br>
- * Non-cooperative kids race to grab jobs
+/** Claims a batch from one shard<br>
+ * Locks the shard's mutex during selection to prevent race conditions.
+ * @param from Shard to claim from
+ * @return Jobs claimed
+ */
+int Kid::claimFrom(JobTable::Shard& from) {
+    int slot;
+    int budget = table->batch;
+    int claimed = 0;
+    lockShard(from);
+    Job* job;
+    while (budget > 0 && (job = table->claim(from, strategy, slot)) != nullptr) {
+        takeJob(job, table->jobs[slot], slot);
+        budget -= job->slow;
+        claimed++;
+    }
+    pthread_mutex_unlock(&from.lock);
+    return claimed;
+}
+
+/** Job Selection wrapper<br>
+ * Calls the path the kid's strategy instantiated for the table's mode:<br>
+ * SHARED kids pop their bucket, STEAL kids work from their own deques,<br>
+ * SCAN kids vector-scan the packed columns and PRIORITY kids pop their heap.
  */
 void Kid::selectJob() {
-    if (mood != Mood::COOPERATIVE) non_Coop_Task_Select();
-    else coop_Task_Select();
+    METRICS_SCOPE(Metric::CLAIM);
+    uint64_t start = Tracer::recording() ? Metrics::now() : 0;
+    size_t before = reserved.size();
+    (this->*StrategyRegistry::get(strategy).select[static_cast<int>(table->mode)])();
+    if (start != 0) Tracer::record(TraceSpan::CLAIM, start, Tracer::kidTrack(id), -1, static_cast<int>(reserved.size() - before));
+}
+
+/** Parks the kid on its bucket's condition variable<br>
+ * Each kid waits on its strategy's bucket; cooperative kids on the general-purpose one.<br>
+ * In STEAL mode the kid parks on its own queue until Mom fills the inbox.<br>
+ * In SCAN mode the kid parks until Mom posts anything after its last pass.<br>
+ * With several shards the kid parks on its home shard for at most
+ * JobTable::remoteRecheckMicros, then returns to look at the other shards,
+ * since posts there do not signal it.<br>
+ * Returns once a claimable job is posted, quitFlag is cleared or a stop is requested.
+ */
+void Kid::waitForJob() {
+    METRICS_SCOPE(Metric::IDLE);
+    ScopedTrace idle(TraceSpan::IDLE, Tracer::kidTrack(id));
+    if (table->mode == SchedMode::STEAL) {
+        JobTable::KidQueue& own = *table->queues[id];
+        pthread_mutex_lock(&own.lock);
+        while (working() && own.inbox.empty()) pthread_cond_wait(&own.cond, &own.lock);
+        pthread_mutex_unlock(&own.lock);
+        return;
+    }
+    JobTable::Shard& own = home();
+    if (table->mode == SchedMode::SCAN) {
+        lockShard(own);
+        while (working() && table->postCount.load() == seenPosts) {
+            pthread_cond_wait(&table->postedCond, &own.lock);
+        }
+        pthread_mutex_unlock(&own.lock);
+        return;
+    }
+    timespec recheck;
+    clock_gettime(CLOCK_REALTIME, &recheck);
+    long ns = recheck.tv_nsec + JobTable::remoteRecheckMicros * 1000;
+    recheck.tv_sec += ns / 1000000000;
+    recheck.tv_nsec = ns % 1000000000;
+    lockShard(own);
+    while (working() && !table->hasReady(own, strategy)) {
+        if (table->shards.size() == 1) {
+            pthread_cond_wait(&own.readyCond[strategy], &own.lock);
+        } else if (pthread_cond_timedwait(&own.readyCond[strategy], &own.lock, &recheck) == ETIMEDOUT) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&own.lock);
+}
+
+/** Starts the next job<br>
+ * Shared by the real-time loop in run() and Mom's virtual clock.
+ * @return true if inProgress now holds a job
+ */
+bool Kid::startNextJob() {
+    if (reserved.empty()) selectJob();
+    if (reserved.empty()) return false;
+    inProgressHandle = reserved.front();
+    reserved.pop_front();
+    inProgress = table->pool.get(inProgressHandle);
+    jobStarted = Tracer::recording() ? Metrics::now() : 0;
+    if (EventLog::enabled()) EventLog::record(EventType::JOB_CLAIMED, id, inProgress->jobNumber, inProgress);
+    return true;
+}
+
+/** Finishes the job in progress<br>
+ * Copies out its record, then announces it, which queues the slot for Mom;<br>
+ * from then on Mom may release the job, so it is not touched again.<br>
+ * The record is kept for printCompletedJob, which prints nothing when the table is quiet.<br>
+ * When tracing, records the job's slice from start to here.
+ */
+void Kid::finishJob() {
+    CompletedJob done = inProgress->summary();
+    inProgress->announceDone(*table);
+    inProgress = nullptr;
+    inProgressHandle = JobHandle{};
+    tableLocks++;  // announceDone takes the table lock once
+    METRICS_JOB_DONE();
+    if (jobStarted != 0) Tracer::record(TraceSpan::JOB, jobStarted, Tracer::kidTrack(id), done.jobNumber, done.value);
+    if (!table->quiet) finishedJobs.push_back(done);
 }
 
 /** Signal handler to react to SIGUSR1 and SIGQUIT<br>
@@ -98,13 +216,11 @@ void Kid::work(int sig) {
     }
 }
 
-/** Main job execution loop
+/** Signal-controlled run
  * - Waits for SIGUSR1 to begin working
- * - Selects mood and prints it
- * - Repeatedly attempts to grab jobs while `quitFlag` is true
- * - Sleeps for duration of job
- * - Announces job completion
- * - Stores completed job in finishedJobs
+ * - Works until Mom clears `quitFlag`
+ * SIGQUIT stays blocked except while sleeping on a job, so a kid is never
+ * stopped while holding the table lock or parked on a condition variable.
  */
 void Kid::run() {
     struct sigaction startAct{};
@@ -122,24 +238,171 @@ void Kid::run() {
         if (ret) perror("sigwait");
         if (signo == SIGUSR1) break;
     }
+    released = chrono::steady_clock::now();
 
+    workLoop();
     pthread_sigmask(SIG_UNBLOCK, &set, nullptr);
-    ss<<"Start working: "<<name<<endl;
-    Printer::write(ss, cout);
-    selectMood();
-    ss<<name<<" mood is: "<<moodName[static_cast<int>(mood)] <<endl;
-    Printer::write(ss, cout);
-
-    while (table->quitFlag) {
-        selectJob();
-        if (inProgress != nullptr && inProgress->status == JobStatus::WORKING) {
-            sleep(inProgress->slow);
-            inProgress->announceDone();
-            finishedJobs.push_back(inProgress);
-            ss<<"Job Completed status: "<< jobStatusName[static_cast<int>(inProgress->status)]<<endl;
-            Printer::write(ss, cout);
+}
+
+/** Token-controlled run
+ * - Reports ready, then waits on the start latch with its siblings
+ * - Works until its stop token is triggered, always finishing the job it is on
+ * @param token Stop token of the kid's jthread
+ * @param ready Counted down once the kid is about to wait for the start
+ * @param start Opened by Mom to release every kid at once
+ */
+void Kid::run(stop_token token, latch& ready, latch& start) {
+    stop = token;
+    ready.count_down();
+    start.wait();
+    released = chrono::steady_clock::now();
+
+    workLoop();
+    if (!EventLog::enabled()) {
+        ss << "\nEnd work: stop requested for " << name << endl;
+        Printer::write(ss, cout);
+    }
+}
+
+/** Coroutine run
+ * - Same loop as workLoop, with the thread-bound steps replaced:
+ *   sleeping on a job is a timer await and waiting for a job parks the
+ *   coroutine on its bucket, so the worker thread moves on to other kids
+ * - Job tasks still run inline on the worker thread
+ * - No per-kid metrics buffer: timings land in the worker's; trace slices
+ *   still go to the kid's own track
+ * @param scheduler Scheduler running this kid
+ */
+KidCoroutine Kid::coRun(KidScheduler& scheduler) {
+    released = chrono::steady_clock::now();
+    Tracer::nameTrack(Tracer::kidTrack(id), name);
+    if (!EventLog::enabled() && !table->quiet) {
+        ss << "Start working: " << name << ", mood is: " << StrategyRegistry::get(strategy).name << endl;
+        Printer::write(ss, cout);
+    }
+    while (working()) {
+        if (startNextJob()) {
+            if (firstClaim == chrono::steady_clock::time_point{}) firstClaim = chrono::steady_clock::now();
+            if (inProgress->hasTask()) inProgress->runTask();
+            else co_await scheduler.sleep(inProgress->slow * table->tick);
+            finishJob();
+            if (!EventLog::enabled() && !table->quiet) {
+                ss << name << " job completed status: " << jobStatusName[static_cast<int>(JobStatus::COMPLETE)] << endl;
+                Printer::write(ss, cout);
+            }
+        } else {
+            co_await JobWait{*this};
         }
     }
+    scheduler.finished();
+}
+
+/** Parks a coroutine kid<br>
+ * The check and the parking happen under the table lock, so a post between
+ * them cannot be missed; the handle is only published once the coroutine is suspended.
+ * @param self The kid's coroutine
+ * @return false to keep running because a job is ready or work is over
+ */
+bool Kid::JobWait::await_suspend(coroutine_handle<> self) {
+    JobTable::Shard& own = kid.home();
+    kid.lockShard(own);
+    if (!kid.working() || kid.table->hasReady(own, kid.strategy)) {
+        pthread_mutex_unlock(&own.lock);
+        return false;
+    }
+    own.parked[kid.strategy].push_back(self);
+    pthread_mutex_unlock(&own.lock);
+    return true;
+}
+
+/** Main job execution loop
+ * - Prints the mood Mom rolled for it
+ * - Attaches its own metrics and trace buffers when those are on
+ * - Repeatedly attempts to grab jobs while `quitFlag` is true and no stop was requested
+ * - Runs jobs it reserved in an earlier claim before claiming again
+ * - Parks on the table when no eligible job is posted
+ * - Runs the job's task, or sleeps for duration of job, JobTable::tick microseconds per unit of slow;
+ *   a task runs with SIGQUIT blocked, so a signal stop lands after it
+ * - Announces job completion
+ * - Stores completed job in finishedJobs
+ * In binary log mode the start, claim and completion messages are
+ * recorded as EventLog events instead of text.
+ */
+void Kid::workLoop() {
+    Metrics::attach(name);
+    Tracer::attach();
+    Tracer::nameTrack(Tracer::kidTrack(id), name);
+    if (EventLog::enabled()) {
+        EventLog::record(EventType::KID_START, id, 0, nullptr, mood);
+    } else {
+        ss<<"Start working: "<<name<<endl;
+        Printer::write(ss, cout);
+        ss<<name<<" mood is: "<<StrategyRegistry::get(strategy).name <<endl;
+        Printer::write(ss, cout);
+    }
+
+    while (working()) {
+        if (startNextJob()) {
+            if (firstClaim == chrono::steady_clock::time_point{}) firstClaim = chrono::steady_clock::now();
+            if (inProgress->hasTask()) {
+                inProgress->runTask();
+            } else {
+                long micros = inProgress->slow * table->tick;
+                timespec nap{micros / 1000000, micros % 1000000 * 1000};
+                pthread_sigmask(SIG_UNBLOCK, &set, nullptr);
+                if (micros > 0) nanosleep(&nap, nullptr);
+                pthread_sigmask(SIG_BLOCK, &set, nullptr);
+            }
+            finishJob();
+            if (!EventLog::enabled() && !table->quiet) {
+                ss<<"Job Completed status: "<< jobStatusName[static_cast<int>(JobStatus::COMPLETE)]<<endl;
+                Printer::write(ss, cout);
+            }
+        } else {
+            waitForJob();
+        }
+    }
+}
+
+/** Worker process loop
+ * - Claims a READY slot its strategy takes, without a lock
+ * - Parks on the segment's condition variable when nothing is claimable
+ * - Sleeps through the job, the segment's tick per unit of slow, and completes it
+ * - Stops at a job boundary once Mom sets quit, or if Mom is gone
+ * Starts scanning at its share of the table, so workers do not all begin on slot 0.
+ * @param shared The segment
+ */
+void Kid::runProcess(ShmTable& shared) {
+    ShmHeader& header = shared.header();
+    ShmKid& counters = shared.kid(id);
+    uint64_t strategyBit = uint64_t(1) << strategy;
+    uint32_t cursor = static_cast<uint32_t>(uint64_t(id) * header.slots / header.kids);
+    uint64_t seen = 0;
+    while (header.quit.load() == 0) {
+        int slot = shared.claim(id, strategyBit, cursor);
+        if (slot < 0) {
+            if (!shared.waitForPost(seen)) break;
+            continue;
+        }
+        ShmSlot& job = shared.slot(slot);
+        uint64_t waited = Metrics::now() - job.postedNs;
+        counters.waitNs += waited;
+        counters.maxWaitNs = max(counters.maxWaitNs, waited);
+        counters.claims.fetch_add(1, memory_order_relaxed);
+        long micros = job.slow * header.tick;
+        timespec nap{micros / 1000000, micros % 1000000 * 1000};
+        if (micros > 0) nanosleep(&nap, nullptr);
+        shared.complete(slot);
+    }
+}
+
+/** Copies a worker's counters into the Kid, so the summary reads them like a thread's
+ * @param counters The kid's record in the segment
+ */
+void Kid::collect(const ShmKid& counters) {
+    claims = counters.claims.load();
+    totalWait = counters.waitNs / 1e9;
+    maxWait = counters.maxWaitNs / 1e9;
 }
 
 /** Prints Kid's name to output stream */
@@ -147,10 +410,11 @@ void Kid::print() {
     Printer::writeln("This is Kid: " + name, cout);
 }
 
-/** Prints all completed jobs by the Kid */
+/** Prints all completed jobs by the Kid, unless the table is quiet */
 void Kid::printCompletedJob() {
-    for (Job* job: finishedJobs) {
-        ss << *job << " was completed by " << job->kidName << endl;
+    if (table->quiet) return;
+    for (const CompletedJob& job: finishedJobs) {
+        ss << job << " was completed by " << name << endl;
         Printer::write(ss, cout);
     }
 }
@@ -3,29 +3,93 @@
 #include "Enums.hpp"
 #include "Job.hpp"
 #include "JobTable.hpp"
+#include "SelectionPolicy.hpp"
+#include "Random.hpp"
+#include "KidScheduler.hpp"
+#include "ShmTable.hpp"
+#include <chrono>
+#include <latch>
+#include <stop_token>
 
 /**
  * @class Kid <br>
  * Represents a child thread that performs jobs assigned by Mom.<br>
- * Each Kid has a name, mood, pointer to the shared JobTable, and tracks completed jobs.
+ * Each Kid has a name, mood, pointer to the shared JobTable, and tracks completed jobs.<br>
+ * Its mood is a SelectionStrategy; the selection paths are templates instantiated
+ * once per SelectionPolicy, so the filter is inlined and never branches on the mood.
  */
 class Kid {
 private:
     string name;                     ///< Name of the Kid <br>
+    int id = 0;                      ///< Index of the Kid, also its queue in STEAL mode <br>
     Mood mood;                       ///< Mood of the Kid (e.g., LAZY, PRISSY) <br>
-    vector<Job*> finishedJobs;       ///< List of completed jobs <br>
+    int strategy = 0;                ///< StrategyRegistry index, also the Kid's ready bucket <br>
+    vector<CompletedJob> finishedJobs;  ///< Records of completed jobs <br>
     Job* inProgress;                 ///< Pointer to job currently in progress <br>
+    JobHandle inProgressHandle;      ///< Pool handle of the job in progress <br>
+    uint64_t jobStarted = 0;         ///< Metrics::now() when the job in progress started, 0 when not tracing <br>
+    deque<JobHandle> reserved;       ///< Claimed jobs not started yet, run in order <br>
     JobTable* table;                 ///< Pointer to shared JobTable <br>
+    int shard = 0;                   ///< Home shard of the table, on the Kid's NUMA node <br>
     sigset_t set{};                  ///< Signal set for thread control <br>
+    long claims = 0;                 ///< Number of jobs this Kid has claimed <br>
+    long remoteClaims = 0;           ///< Claims taken from a shard other than the home one <br>
+    long tableLocks = 0;             ///< Times this Kid has taken a shard lock <br>
+    uint64_t seenPosts = 0;          ///< Table postCount when the last SCAN pass started <br>
+    size_t scanCursor = SIZE_MAX;    ///< Slot the next SCAN pass starts at, moved past each claim <br>
+    Rng rng;                         ///< The Kid's own random stream, seeded by Mom <br>
+    stop_token stop;                 ///< Stop token of the Kid's jthread, empty under signal control <br>
+    chrono::steady_clock::time_point released;    ///< When the Kid was let go by SIGUSR1 or the start latch <br>
+    chrono::steady_clock::time_point firstClaim;  ///< When the Kid claimed its first job <br>
+    double totalWait = 0;            ///< Seconds its claimed jobs had waited since being posted <br>
+    double maxWait = 0;              ///< Longest any of its claimed jobs had waited <br>
 
-    /** Selects a job using non-cooperative strategy */
-    void non_Coop_Task_Select();
+    /** Selects a job from the ready bucket, or in PRIORITY mode the heap, of the Kid's strategy<br>
+     * Tries the home shard first and the others only if it has nothing.
+     */
+    void bucket_Task_Select();
+
+    /** Claims up to the batch budget from one shard's bucket<br>
+     * @param from Shard to claim from
+     * @return Number of jobs claimed
+     */
+    int claimFrom(JobTable::Shard& from);
+
+    /** Selects a job from the Kid's own deque, stealing from others when it is empty */
+    template <SelectionPolicy P>
+    void steal_Task_Select();
+
+    /** Selects a job by SIMD-scanning the table's packed columns */
+    template <SelectionPolicy P>
+    void scan_Task_Select();
+
+    /** Marks a claimed job as the Kid's and queues it in reserved */
+    void takeJob(Job* job, JobHandle handle, int slot);
+
+    /** Returns the Kid's home shard */
+    JobTable::Shard& home() const { return *table->shards[shard]; }
 
-    /** Selects a job using cooperative strategy */
-    void coop_Task_Select();
+    /** Locks a shard of the table, counting the acquisition */
+    void lockShard(JobTable::Shard& locked);
 
-    /** Checks if the Kid is willing to do the job based on mood */
-    bool moodChecker(Job&);
+    /** Claims and works through jobs until told to stop */
+    void workLoop();
+
+    /** Checks whether the Kid should keep working<br>
+     * @return false once quitFlag is cleared or a stop is requested
+     */
+    bool working() const { return table->quitFlag && !stop.stop_requested(); }
+
+    /** Awaitable that parks a coroutine Kid on its bucket until a job it can claim is posted<br>
+     * Does not suspend if one is already waiting or work is over.
+     */
+    struct JobWait {
+        Kid& kid;
+
+        bool await_ready() const { return false; }
+        bool await_suspend(coroutine_handle<> self);
+        void await_resume() const {}
+    };
 
     /** Static signal handler to trigger job selection and execution */
     static void work(int sig);
@@ -40,22 +104,215 @@ public:
     /**
      * Parameterized constructor <br>
      * @param name Name of the Kid <br>
+     * @param id Index of the Kid among its siblings <br>
      * @param table Pointer to the shared JobTable <br>
      */
-    Kid(const string& name, JobTable* table);
+    Kid(const string& name, int id, JobTable* table);
+
+    /** Generates the name of the Kid with a given index<br>
+     * The first four are Ali, Cory, Lee and Pat; later kids reuse<br>
+     * those names with a round number, e.g. Ali2, Cory2.<br>
+     * @param id Index of the Kid <br>
+     * @return The generated name
+     */
+    static string makeName(int id) {
+        static const string baseNames[] = {"Ali", "Cory", "Lee", "Pat"};
+        string generated = baseNames[id % 4];
+        if (id >= 4) generated += to_string(id / 4 + 1);
+        return generated;
+    }
+
+    /** Builds the runtime record of a selection policy<br>
+     * Every selection path is instantiated for P here.<br>
+     * @return Record to pass to StrategyRegistry::add
+     */
+    template <SelectionPolicy P>
+    static SelectionStrategy strategyFor() {
+        return {P::name, P::mood, [](const Job& job) { return P::eligible(job); },
+                {&Kid::bucket_Task_Select, &Kid::steal_Task_Select<P>, &Kid::scan_Task_Select<P>, &Kid::bucket_Task_Select}};
+    }
+
+    /** Randomly assigns a registered strategy, and its mood, to the Kid<br>
+     * @param seed Run seed; the Kid draws from stream id + 1
+     * @param forced StrategyRegistry index to use instead of rolling one, -1 to roll
+     */
+    void selectMood(uint64_t seed, int forced = -1);
+
+    /** Returns the Kid's mood, valid once selectMood has run */
+    Mood getMood() const { return mood; }
+
+    /** Returns the Kid's StrategyRegistry index, valid once selectMood has run */
+    int getStrategy() const { return strategy; }
+
+    /** Sets the shard the Kid claims from first<br>
+     * @param home Shard index, normally the one on the NUMA node of the Kid's CPU
+     */
+    void setShard(int home) { shard = home; }
+
+    /** Returns the Kid's home shard index */
+    int getShard() const { return shard; }
+
+    /** Returns how many of its claims came from a shard other than its home one */
+    long remoteClaimCount() const { return remoteClaims; }
+
+    /** Returns how many jobs the Kid has claimed */
+    long claimCount() const { return claims; }
+
+    /** Returns the seconds its claimed jobs waited, summed over claims */
+    double totalWaitTime() const { return totalWait; }
 
-    /** Randomly assigns a mood to the Kid */
-    void selectMood();
+    /** Returns the longest wait of any job the Kid claimed */
+    double maxWaitTime() const { return maxWait; }
+
+    /** Returns how many times the Kid has taken a shard lock */
+    long tableLockCount() const { return tableLocks; }
+
+    /** Hands reserved but unstarted jobs back to the table<br>
+     * Called by Mom once the Kid's thread has been joined.
+     */
+    void returnReserved();
 
     /** Determines job selection strategy based on mood */
     void selectJob();
 
-    /** Main execution loop for the Kid */
+    /** Moves the next reserved job into inProgress, claiming first if none is reserved<br>
+     * Never blocks; records a JOB_CLAIMED event in binary log mode.<br>
+     * @return true if the Kid now has a job to work on
+     */
+    bool startNextJob();
+
+    /** Announces the job in progress and files its record under finishedJobs<br>
+     * The job may be released once announced, so inProgress is cleared.
+     */
+    void finishJob();
+
+    /** Returns the job in progress, valid after startNextJob returned true */
+    Job* currentJob() const { return inProgress; }
+
+    /** Parks the Kid until a job it can claim is posted or work is over */
+    void waitForJob();
+
+    /** Main execution loop for the Kid, started by SIGUSR1 and stopped by SIGQUIT */
     void run();
 
+    /** Main execution loop for the Kid under token control<br>
+     * @param token Stop token of the Kid's jthread<br>
+     * @param ready Counted down once the Kid is waiting to start<br>
+     * @param start Latch Mom opens to release all kids at once
+     */
+    void run(stop_token token, latch& ready, latch& start);
+
+    /** Main execution loop for a coroutine Kid, run M:N by a KidScheduler<br>
+     * Sleeping through a job and waiting for one suspend the coroutine instead of a thread.<br>
+     * @param scheduler Scheduler the Kid was spawned on
+     * @return The suspended coroutine, to pass to KidScheduler::spawn
+     */
+    KidCoroutine coRun(KidScheduler& scheduler);
+
+    /** Main execution loop for a Kid run as a worker process, with --processes<br>
+     * Claims from the shared-memory table and sleeps through each job until Mom stops the workers.<br>
+     * Prints nothing: the worker was forked from Mom and shares her output streams.<br>
+     * @param shared The segment, mapped by this process
+     */
+    void runProcess(ShmTable& shared);
+
+    /** Takes the claim count and waits a worker process recorded in the segment<br>
+     * Called by Mom once the worker has exited.<br>
+     * @param counters The kid's record in the segment
+     */
+    void collect(const ShmKid& counters);
+
+    /** Returns when the Kid was released to start working */
+    chrono::steady_clock::time_point releaseTime() const { return released; }
+
+    /** Returns when the Kid claimed its first job, or a default time point if it never did */
+    chrono::steady_clock::time_point firstClaimTime() const { return firstClaim; }
+
     /** Prints Kid's name */
     void print();
 
     /** Prints all completed jobs by the Kid */
     void printCompletedJob();
 };
+
+/**
+ * Registers a SelectionPolicy so kids can roll it as a mood<br>
+ * Use once at namespace scope in any source file linked into the program.
+ */
+#define REGISTER_SELECTION_POLICY(P) \
+    static const int P##StrategyIndex = StrategyRegistry::add(Kid::strategyFor<P>())
+
+/** Selects task in STEAL mode<br>
+ * Pops the kid's own deque without locking the table.<br>
+ * An empty deque is refilled from the inbox Mom writes to.<br>
+ * When both are empty the kid steals from its siblings,<br>
+ * taking only jobs that pass P's filter; the filter may see a handle<br>
+ * whose job was already done and released, which it turns down.
+ */
+template <SelectionPolicy P>
+void Kid::steal_Task_Select() {
+    JobTable::KidQueue& own = *table->queues[id];
+    JobHandle handle = own.deque.pop();
+    if (!handle.valid()) {
+        pthread_mutex_lock(&own.lock);
+        own.drained.swap(own.inbox);
+        pthread_mutex_unlock(&own.lock);
+        for (JobHandle incoming : own.drained) own.deque.push(incoming);
+        own.drained.clear();
+        handle = own.deque.pop();
+    }
+    size_t kidCount = table->queues.size();
+    for (size_t k = 1; !handle.valid() && k < kidCount; k++) {
+        JobTable::KidQueue& victim = *table->queues[(id + k) % kidCount];
+        handle = victim.deque.steal([this](JobHandle candidate) {
+            const Job* job = table->pool.get(candidate);
+            return job != nullptr && P::eligible(*job);
+        });
+    }
+    Job* job = table->pool.get(handle);
+    if (job != nullptr) takeJob(job, handle, job->jobNumber);
+}
+
+/** Selects task in SCAN mode<br>
+ * Tests 32 slots per step with the JobColumns kernel for P's mood, starting at the<br>
+ * Kid's cursor and wrapping once, going up the table or down it when P asks for it.<br>
+ * The cursor moves past each claimed slot, as ShmTable::claim does, so a loaded<br>
+ * table is worked round and its far slots are not starved by the near ones.<br>
+ * A slot is claimed with a CAS on its status byte, without the table lock.<br>
+ * The job is re-checked with P's filter after the CAS, because the vector loads
+ * may have seen a slot while Mom was refilling it and because P may be stricter
+ * than the kernel; a mismatch is put back.
+ */
+template <SelectionPolicy P>
+void Kid::scan_Task_Select() {
+    JobColumns& columns = table->columns;
+    seenPosts = table->postCount.load(memory_order_acquire);
+    size_t blocks = columns.blocks();
+    size_t slots = blocks * JobColumns::block;
+    if (scanCursor >= slots) scanCursor = P::fromEnd ? slots - 1 : 0;
+    size_t first = scanCursor / JobColumns::block;
+    uint32_t bit0 = static_cast<uint32_t>(scanCursor % JobColumns::block);
+    // Slots of the first block from the cursor on, in scan order; the rest are visited last
+    uint32_t ahead = P::fromEnd ? (bit0 == 31 ? ~0u : (2u << bit0) - 1) : ~0u << bit0;
+    for (size_t k = 0; k <= blocks; k++) {
+        size_t b = P::fromEnd ? (first + blocks - k % blocks) % blocks : (first + k) % blocks;
+        size_t base = b * JobColumns::block;
+        uint32_t mask = columns.eligible(P::mood, base);
+        if (k == 0) mask &= ahead;
+        else if (k == blocks) mask &= ~ahead;
+        while (mask != 0) {
+            int bit = P::fromEnd ? 31 - __builtin_clz(mask) : __builtin_ctz(mask);
+            mask &= ~(1u << bit);
+            size_t slot = base + bit;
+            if (!columns.tryClaim(slot)) continue;
+            Job* job = table->at(static_cast<int>(slot));
+            if (!P::eligible(*job)) {
+                columns.setStatus(slot, JobStatus::NOT_STARTED);
+                continue;
+            }
+            takeJob(job, table->jobs[slot], static_cast<int>(slot));
+            scanCursor = P::fromEnd ? (slot + slots - 1) % slots : (slot + 1) % slots;
+            return;
+        }
+    }
+}
@@ -0,0 +1,177 @@
+#include "KidScheduler.hpp"
+#include "Metrics.hpp"
+#include "Tracer.hpp"
+
+/** Constructor: initializes the lock and condition variables */
+KidScheduler::KidScheduler() {
+    pthread_mutex_init(&lock, nullptr);
+    pthread_cond_init(&wake, nullptr);
+    pthread_cond_init(&drained, nullptr);
+}
+
+/** Destructor: stops the workers if join() was never called */
+KidScheduler::~KidScheduler() {
+    if (!workers.empty()) {
+        pthread_mutex_lock(&lock);
+        stopping = true;
+        pthread_cond_broadcast(&wake);
+        pthread_mutex_unlock(&lock);
+        for (pthread_t worker : workers) pthread_join(worker, nullptr);
+    }
+    pthread_cond_destroy(&drained);
+    pthread_cond_destroy(&wake);
+    pthread_mutex_destroy(&lock);
+}
+
+/**
+ * Queues a new kid<br>
+ * --------------------------------------------------
+ * @param kid Coroutine suspended at its start
+ */
+void KidScheduler::spawn(KidCoroutine kid) {
+    pthread_mutex_lock(&lock);
+    live++;
+    ready.push_back(kid.handle);
+    pthread_mutex_unlock(&lock);
+}
+
+/**
+ * Starts the workers<br>
+ * --------------------------------------------------
+ * @param threads Number of worker pthreads
+ */
+void KidScheduler::start(int threads) {
+    stats.resize(threads);
+    workers.resize(threads);
+    for (int i = 0; i < threads; i++) {
+        auto* arg = new pair<KidScheduler*, int>(this, i);
+        pthread_create(&workers[i], nullptr, workerMain, arg);
+    }
+}
+
+/** pthread entry point: unpacks the scheduler and worker number */
+void* KidScheduler::workerMain(void* arg) {
+    auto* self = static_cast<pair<KidScheduler*, int>*>(arg);
+    KidScheduler* scheduler = self->first;
+    int index = self->second;
+    delete self;
+    scheduler->workerLoop(index);
+    return nullptr;
+}
+
+/**
+ * Makes a kid ready<br>
+ * --------------------------------------------------
+ * - Wakes one idle worker.
+ * @param kid Suspended coroutine
+ */
+void KidScheduler::schedule(coroutine_handle<> kid) {
+    pthread_mutex_lock(&lock);
+    ready.push_back(kid);
+    pthread_cond_signal(&wake);
+    pthread_mutex_unlock(&lock);
+}
+
+/**
+ * Adds a timer<br>
+ * --------------------------------------------------
+ * - Workers sleeping until a later timer are woken to re-arm.
+ * @param due When the kid should run again
+ * @param kid Suspended coroutine
+ */
+void KidScheduler::wakeAt(chrono::steady_clock::time_point due, coroutine_handle<> kid) {
+    pthread_mutex_lock(&lock);
+    bool earliest = timers.empty() || due < timers.top().due;
+    timers.push({due, kid});
+    if (earliest) pthread_cond_signal(&wake);
+    pthread_mutex_unlock(&lock);
+}
+
+/**
+ * Worker loop<br>
+ * --------------------------------------------------
+ * - Moves due timers to the ready queue, resumes the oldest ready kid with the
+ *   lock released, and sleeps until the next timer when there is nothing to run.
+ * - Exits once stopping is set and nothing is ready.
+ * - Records its metrics as "worker<i>", since kids no longer own threads;
+ *   its trace buffer holds the slices of whichever kids it resumes.
+ * @param index Worker number
+ */
+void KidScheduler::workerLoop(int index) {
+    Metrics::attach("worker" + to_string(index));
+    Tracer::attach();
+    WorkerStats& mine = stats[index];
+    uint64_t busySince = Metrics::now();
+    pthread_mutex_lock(&lock);
+    while (true) {
+        auto now = chrono::steady_clock::now();
+        while (!timers.empty() && timers.top().due <= now) {
+            ready.push_back(timers.top().kid);
+            timers.pop();
+        }
+        if (!ready.empty()) {
+            coroutine_handle<> kid = ready.front();
+            ready.pop_front();
+            pthread_mutex_unlock(&lock);
+            uint64_t before = Metrics::now();
+            kid.resume();
+            mine.inKidsNs += Metrics::now() - before;
+            mine.resumes++;
+            pthread_mutex_lock(&lock);
+            continue;
+        }
+        if (stopping) break;
+        mine.busyNs += Metrics::now() - busySince;
+        if (timers.empty()) {
+            pthread_cond_wait(&wake, &lock);
+        } else {
+            // The condition variable runs on CLOCK_REALTIME; convert the steady deadline
+            auto wait = timers.top().due - chrono::steady_clock::now();
+            timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            long long ns = deadline.tv_nsec + max<long long>(0, chrono::duration_cast<chrono::nanoseconds>(wait).count());
+            deadline.tv_sec += ns / 1000000000;
+            deadline.tv_nsec = ns % 1000000000;
+            pthread_cond_timedwait(&wake, &lock, &deadline);
+        }
+        busySince = Metrics::now();
+    }
+    mine.busyNs += Metrics::now() - busySince;
+    pthread_mutex_unlock(&lock);
+}
+
+/** Counts a returned kid and wakes join() after the last one */
+void KidScheduler::finished() {
+    pthread_mutex_lock(&lock);
+    if (--live == 0) pthread_cond_broadcast(&drained);
+    pthread_mutex_unlock(&lock);
+}
+
+/**
+ * Stops the pool<br>
+ * --------------------------------------------------
+ * - Kids still sleeping on a job finish it first, as under token control.
+ */
+void KidScheduler::join() {
+    pthread_mutex_lock(&lock);
+    while (live > 0) pthread_cond_wait(&drained, &lock);
+    stopping = true;
+    pthread_cond_broadcast(&wake);
+    pthread_mutex_unlock(&lock);
+    for (pthread_t worker : workers) pthread_join(worker, nullptr);
+    workers.clear();
+}
+
+/** @return Resumes summed over the workers */
+long KidScheduler::resumes() const {
+    long total = 0;
+    for (const WorkerStats& worker : stats) total += worker.resumes;
+    return total;
+}
+
+/** @return Busy time outside kids, per resume */
+double KidScheduler::overheadPerResume() const {
+    uint64_t overhead = 0;
+    for (const WorkerStats& worker : stats) overhead += worker.busyNs - min(worker.busyNs, worker.inKidsNs);
+    return double(overhead) / max(resumes(), 1L);
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include "tools.hpp"
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <deque>
+#include <queue>
+
+/**
+ * KidCoroutine struct<br>
+ * ------------------------------------------------------<br>
+ * - Return type of a coroutine kid's loop (Kid::coRun).<br>
+ * - Starts suspended so KidScheduler decides when it first runs, and frees its
+ *   own frame when the loop returns.<br>
+ * - Frame allocations are counted, so Mom can report the bytes each kid costs.<br>
+ */
+struct KidCoroutine {
+    struct promise_type {
+        static inline atomic<size_t> frameBytes{0};  ///< Bytes of every frame allocated so far
+        static inline atomic<size_t> frames{0};      ///< Frames allocated so far
+
+        static void* operator new(size_t size) {
+            frameBytes.fetch_add(size, memory_order_relaxed);
+            frames.fetch_add(1, memory_order_relaxed);
+            return ::operator new(size);
+        }
+        static void operator delete(void* frame) { ::operator delete(frame); }
+
+        KidCoroutine get_return_object() { return {coroutine_handle<promise_type>::from_promise(*this)}; }
+        suspend_always initial_suspend() noexcept { return {}; }
+        suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { terminate(); }
+    };
+
+    coroutine_handle<promise_type> handle;  ///< Not owned: the frame frees itself when the loop ends
+};
+
+/**
+ * KidScheduler class<br>
+ * ------------------------------------------------------<br>
+ * - Runs coroutine kids M:N on a fixed pool of worker pthreads.<br>
+ * - A ready queue and a timer min-heap, both under one mutex; a worker resumes
+ *   ready kids, moves due timers to the ready queue, and otherwise sleeps on a
+ *   condition variable until the next timer or a wake-up.<br>
+ * - Kids waiting for a job are not here: they park on their JobTable bucket,
+ *   which hands them back through schedule() when a job is posted.<br>
+ * - Workers count resumes and split their busy time into time inside kids and
+ *   time in the scheduler itself, reported as overhead per resume.<br>
+ */
+class KidScheduler {
+private:
+    /** A sleeping kid and when it is due */
+    struct Timer {
+        chrono::steady_clock::time_point due;
+        coroutine_handle<> kid;
+        bool operator>(const Timer& other) const { return due > other.due; }
+    };
+
+    /** Per-worker counters, read once the workers have stopped */
+    struct WorkerStats {
+        long resumes = 0;
+        uint64_t busyNs = 0;      ///< Time not spent waiting for work
+        uint64_t inKidsNs = 0;    ///< Time inside resumed kids
+    };
+
+    pthread_mutex_t lock{};
+    pthread_cond_t wake{};         ///< Signalled on new ready kids, earlier timers, and shutdown
+    pthread_cond_t drained{};      ///< Broadcast when the last kid returns
+    deque<coroutine_handle<>> ready;
+    priority_queue<Timer, vector<Timer>, greater<>> timers;
+    vector<pthread_t> workers;
+    vector<WorkerStats> stats;
+    bool stopping = false;
+    long live = 0;                 ///< Kids spawned and not yet returned
+
+    /** Worker loop<br>
+     * @param index Worker number, used for its stats and metrics name
+     */
+    void workerLoop(int index);
+
+    static void* workerMain(void* arg);
+
+public:
+    /** Awaitable that suspends a kid for a number of microseconds */
+    struct Sleep {
+        KidScheduler& scheduler;
+        long micros;
+
+        bool await_ready() const { return micros <= 0; }
+        void await_suspend(coroutine_handle<> kid) { scheduler.wakeAt(chrono::steady_clock::now() + chrono::microseconds(micros), kid); }
+        void await_resume() const {}
+    };
+
+    KidScheduler();
+    ~KidScheduler();
+
+    KidScheduler(const KidScheduler&) = delete;
+    KidScheduler& operator=(const KidScheduler&) = delete;
+
+    /** Queues a new kid; it first runs once the workers are started<br>
+     * @param kid Suspended coroutine returned by Kid::coRun
+     */
+    void spawn(KidCoroutine kid);
+
+    /** Starts the worker threads<br>
+     * @param threads Number of OS threads the kids share
+     */
+    void start(int threads);
+
+    /** Makes a suspended kid ready to run; safe from any thread */
+    void schedule(coroutine_handle<> kid);
+
+    /** Puts a kid to sleep until a time point */
+    void wakeAt(chrono::steady_clock::time_point due, coroutine_handle<> kid);
+
+    /** Returns a Sleep awaitable<br>
+     * @param micros Microseconds to sleep
+     */
+    Sleep sleep(long micros) { return {*this, micros}; }
+
+    /** Called by a kid's loop right before it returns */
+    void finished();
+
+    /** Waits for every kid to return, then stops and joins the workers */
+    void join();
+
+    /** Returns the number of kids resumed over the run, valid after join() */
+    long resumes() const;
+
+    /** Returns the scheduler's own time per resume in nanoseconds, valid after join() */
+    double overheadPerResume() const;
+};
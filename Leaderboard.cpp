@@ -0,0 +1,55 @@
+#include "Leaderboard.hpp"
+#include "Kid.hpp"
+
+/**
+ * Sizes the board<br>
+ * --------------------------------------------------
+ * @param kids Number of kids
+ */
+void Leaderboard::resize(int kids) {
+    scores = make_unique<Score[]>(kids);
+    count = kids;
+}
+
+/**
+ * Takes a snapshot<br>
+ * --------------------------------------------------
+ * @return One entry per kid, in kid order
+ */
+vector<Leaderboard::Entry> Leaderboard::snapshot() const {
+    vector<Entry> entries;
+    entries.reserve(count);
+    for (int k = 0; k < count; k++) {
+        entries.push_back({k, scores[k].jobs.load(memory_order_relaxed), scores[k].value.load(memory_order_relaxed)});
+    }
+    return entries;
+}
+
+/**
+ * Finds the leader<br>
+ * --------------------------------------------------
+ * @return Entry of the kid with the highest value
+ */
+Leaderboard::Entry Leaderboard::leader() const {
+    Entry best{-1, 0, -1};
+    for (int k = 0; k < count; k++) {
+        long value = scores[k].value.load(memory_order_relaxed);
+        if (value > best.value) best = {k, scores[k].jobs.load(memory_order_relaxed), value};
+    }
+    return best;
+}
+
+/**
+ * Prints the board<br>
+ * --------------------------------------------------
+ * - Kids are ranked by value, ties in kid order, e.g. "Cory 120 (12 jobs), Ali 98 (9 jobs)".
+ * @param out Stream to format into
+ */
+void Leaderboard::print(ostream& out) const {
+    vector<Entry> entries = snapshot();
+    stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.value > b.value; });
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (i > 0) out << ", ";
+        out << Kid::makeName(entries[i].kidId) << " " << entries[i].value << " (" << entries[i].jobs << " jobs)";
+    }
+}
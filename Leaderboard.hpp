@@ -0,0 +1,62 @@
+#pragma once
+#include "tools.hpp"
+#include <atomic>
+#include <memory>
+
+/**
+ * Leaderboard class<br>
+ * ------------------------------------------------------<br>
+ * - Running earnings per kid: jobs done and total value.<br>
+ * - Each kid's counters sit on their own cache line and are bumped with relaxed
+ *   atomic adds in Job::announceDone, so kids never contend or take a lock.<br>
+ * - snapshot() and leader() read every kid once, O(kids), from any thread at any time.
+ *   A kid's two counters may be one job apart in a snapshot taken mid-run.<br>
+ */
+class Leaderboard {
+private:
+    /** Counters of one kid, padded to a cache line */
+    struct alignas(64) Score {
+        atomic<long> jobs{0};
+        atomic<long> value{0};
+    };
+
+    unique_ptr<Score[]> scores;    ///< One Score per kid
+    int count = 0;                 ///< Number of kids
+
+public:
+    /** One kid's standing */
+    struct Entry {
+        int kidId;      ///< Kid index, see Kid::makeName
+        long jobs;      ///< Jobs completed
+        long value;     ///< Total value earned
+    };
+
+    /** Sizes the board, before any kid starts<br>
+     * @param kids Number of kids
+     */
+    void resize(int kids);
+
+    /** Credits a completed job to a kid<br>
+     * @param kidId Kid that did the job
+     * @param value Value of the job
+     */
+    void credit(int kidId, int value) {
+        scores[kidId].jobs.fetch_add(1, memory_order_relaxed);
+        scores[kidId].value.fetch_add(value, memory_order_relaxed);
+    }
+
+    /** Reads every kid's standing<br>
+     * @return Entries in kid order
+     */
+    vector<Entry> snapshot() const;
+
+    /** Finds the kid with the most value, ties going to the lower index<br>
+     * @return The leader's entry, or kidId -1 when there are no kids
+     */
+    Entry leader() const;
+
+    /** Prints a snapshot ranked by value, as one line<br>
+     * @param out Stream to format into
+     */
+    void print(ostream& out) const;
+};
@@ -0,0 +1,387 @@
+#include "Ledger.hpp"
+#include "Metrics.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+
+/**
+ * SnapshotHeader struct<br>
+ * ------------------------------------------------------<br>
+ * - Start of snapshot.bin. Then come the ratings, three bytes per slot padded
+ *   to 8 bytes, then jobs and value per kid as two int64_t each.<br>
+ * - check is FNV-1a over the header, with check zeroed, and the body.<br>
+ */
+struct SnapshotHeader {
+    char magic[8];         ///< "TDSNAP01"
+    uint32_t version;      ///< Format version, currently 1
+    uint32_t tableSize;    ///< Slots in the table
+    uint32_t kids;         ///< Kid entries in the body
+    uint32_t reserved;     ///< Zero
+    uint64_t records;      ///< Ledger records the snapshot covers
+    int64_t value;         ///< Value of those completions
+    uint64_t check;        ///< Checksum of header and body
+};
+
+/** Magic at the start of ledger.bin, followed by the version and record size */
+static const char ledgerMagic[8] = {'T', 'D', 'L', 'E', 'D', 'G', 'R', '1'};
+
+/** FNV-1a over a byte range, continuing from hash */
+static uint64_t fnv1a(const void* data, size_t bytes, uint64_t hash = 0xCBF29CE484222325ull) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < bytes; i++) hash = (hash ^ p[i]) * 0x100000001B3ull;
+    return hash;
+}
+
+/** Bytes of snapshot.bin for a table size and kid count */
+static size_t snapshotBytes(size_t tableSize, size_t kids) {
+    return sizeof(SnapshotHeader) + ((tableSize * 3 + 7) & ~size_t(7)) + kids * 2 * sizeof(int64_t);
+}
+
+/** Checksum of a mapped snapshot, header check field excluded */
+static uint64_t snapshotCheck(const uint8_t* file, size_t bytes) {
+    SnapshotHeader header;
+    memcpy(&header, file, sizeof(header));
+    header.check = 0;
+    return fnv1a(file + sizeof(header), bytes - sizeof(header), fnv1a(&header, sizeof(header)));
+}
+
+/** Writes a whole buffer, retrying short writes */
+static bool writeAll(int fd, const void* data, size_t bytes) {
+    const char* p = static_cast<const char*>(data);
+    while (bytes > 0) {
+        ssize_t n = ::write(fd, p, bytes);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        bytes -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+/**
+ * Counts a completion<br>
+ * --------------------------------------------------
+ * - The slot takes the replacement job's ratings; the kid's totals grow.
+ * @param record Ledger record
+ */
+void LedgerState::apply(const LedgerRecord& record) {
+    if (record.kid >= kidJobs.size()) {
+        kidJobs.resize(record.kid + 1);
+        kidValue.resize(record.kid + 1);
+    }
+    kidJobs[record.kid]++;
+    kidValue[record.kid] += record.value;
+    uint8_t* slot = &ratings[3 * size_t(record.slot)];
+    slot[0] = record.nextSlow;
+    slot[1] = record.nextDirty;
+    slot[2] = record.nextHeavy;
+    value += record.value;
+    records = record.seq + 1;
+}
+
+/** Constructor: initializes the lock and condition variables */
+Ledger::Ledger() {
+    pthread_mutex_init(&lock, nullptr);
+    pthread_cond_init(&wake, nullptr);
+    pthread_cond_init(&committed, nullptr);
+}
+
+/** Destructor: commits and stops the committer if close() was never called */
+Ledger::~Ledger() {
+    close();
+    pthread_cond_destroy(&committed);
+    pthread_cond_destroy(&wake);
+    pthread_mutex_destroy(&lock);
+}
+
+/**
+ * Opens the ledger<br>
+ * --------------------------------------------------
+ * - A new ledger.bin gets its header and is synced before any record.
+ * @param directory Ledger directory
+ * @param commitWindowMicros Group commit window
+ * @return true on success
+ */
+bool Ledger::open(const string& directory, long commitWindowMicros) {
+    dir = directory;
+    commitMicros = commitWindowMicros;
+    if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) return false;
+    fd = ::open((dir + "/ledger.bin").c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) return false;
+
+    char header[headerBytes]{};
+    memcpy(header, ledgerMagic, 8);
+    uint32_t version = 1, recordSize = sizeof(LedgerRecord);
+    memcpy(header + 8, &version, 4);
+    memcpy(header + 12, &recordSize, 4);
+    struct stat info{};
+    fstat(fd, &info);
+    if (info.st_size == 0) {
+        if (!writeAll(fd, header, headerBytes) || fdatasync(fd) != 0) return false;
+    } else {
+        char found[headerBytes]{};
+        if (pread(fd, found, headerBytes, 0) != static_cast<ssize_t>(headerBytes) || memcmp(found, header, headerBytes) != 0) return false;
+    }
+    pthread_create(&committer, nullptr, committerMain, this);
+    running = true;
+    return true;
+}
+
+/** pthread entry point */
+void* Ledger::committerMain(void* arg) {
+    static_cast<Ledger*>(arg)->commitLoop();
+    return nullptr;
+}
+
+/**
+ * Committer loop<br>
+ * --------------------------------------------------
+ * - Sleeps until a batch starts, then lets records gather for the commit
+ *   window unless a sync() is waiting or the batch reaches batchLimit.
+ * - Writes and syncs with the lock released, so Mom keeps appending to the next batch.
+ * - On stopping, commits whatever is still pending before it exits.
+ */
+void Ledger::commitLoop() {
+    pthread_mutex_lock(&lock);
+    while (true) {
+        while (pending.empty() && !stopping) pthread_cond_wait(&wake, &lock);
+        if (pending.empty()) break;
+
+        timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        long ns = deadline.tv_nsec + commitMicros * 1000;
+        deadline.tv_sec += ns / 1000000000;
+        deadline.tv_nsec = ns % 1000000000;
+        while (!urgent && !stopping && pending.size() < batchLimit) {
+            if (pthread_cond_timedwait(&wake, &lock, &deadline) == ETIMEDOUT) break;
+        }
+        urgent = false;
+        writing.swap(pending);
+        pthread_mutex_unlock(&lock);
+
+        uint64_t start = Metrics::now();
+        bool ok = writeAll(fd, writing.data(), writing.size() * sizeof(LedgerRecord)) && fdatasync(fd) == 0;
+        uint64_t took = Metrics::now() - start;
+
+        pthread_mutex_lock(&lock);
+        if (ok) {
+            durable += writing.size();
+        } else if (!failed) {
+            failed = true;
+            cerr << "Ledger write to " << dir << " failed: " << strerror(errno) << endl;
+        }
+        commits++;
+        syncNs += took;
+        largestBatch = max(largestBatch, writing.size());
+        writing.clear();
+        pthread_cond_broadcast(&committed);
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+/**
+ * Restores the previous run<br>
+ * --------------------------------------------------
+ * - The snapshot gives the table and the totals as of its ledger position.
+ * - Records from that position on are checked one by one; the first with a
+ *   wrong seq or checksum ends the ledger, and the file is cut there.
+ * @param tableSize Slots this run has
+ * @param kids Kids this run has
+ * @param state Receives the restored state
+ */
+void Ledger::restore(int tableSize, int kids, LedgerState& state) {
+    state = LedgerState{};
+    state.kidJobs.assign(kids, 0);
+    state.kidValue.assign(kids, 0);
+    struct stat info{};
+    fstat(fd, &info);
+    uint64_t inLedger = (static_cast<uint64_t>(info.st_size) - headerBytes) / sizeof(LedgerRecord);
+
+    string path = dir + "/snapshot.bin";
+    int in = ::open(path.c_str(), O_RDONLY);
+    if (in < 0) {
+        if (inLedger > 0) fatal("Ledger in " + dir + " has " + to_string(inLedger) + " records but no snapshot");
+        return;
+    }
+    struct stat snapInfo{};
+    fstat(in, &snapInfo);
+    size_t bytes = static_cast<size_t>(snapInfo.st_size);
+    void* mapped = bytes >= sizeof(SnapshotHeader) ? mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, in, 0) : MAP_FAILED;
+    ::close(in);
+    if (mapped == MAP_FAILED) fatal("Cannot read snapshot " + path);
+    const uint8_t* file = static_cast<const uint8_t*>(mapped);
+    SnapshotHeader header;
+    memcpy(&header, file, sizeof(header));
+    if (memcmp(header.magic, "TDSNAP01", 8) != 0 || header.version != 1 || bytes != snapshotBytes(header.tableSize, header.kids)
+        || snapshotCheck(file, bytes) != header.check) {
+        fatal("Snapshot " + path + " is corrupt");
+    }
+    if (header.tableSize != static_cast<uint32_t>(tableSize)) {
+        fatal("Snapshot " + path + " was taken with --table " + to_string(header.tableSize));
+    }
+    if (header.records > inLedger) {
+        fatal("Snapshot " + path + " covers " + to_string(header.records) + " records but the ledger holds " + to_string(inLedger));
+    }
+
+    const uint8_t* body = file + sizeof(header);
+    state.ratings.assign(body, body + 3 * size_t(tableSize));
+    const int64_t* totals = reinterpret_cast<const int64_t*>(body + ((tableSize * 3 + 7) & ~size_t(7)));
+    if (header.kids > static_cast<uint32_t>(kids)) {
+        state.kidJobs.resize(header.kids);
+        state.kidValue.resize(header.kids);
+    }
+    for (uint32_t k = 0; k < header.kids; k++) {
+        state.kidJobs[k] = totals[2 * k];
+        state.kidValue[k] = totals[2 * k + 1];
+    }
+    state.records = header.records;
+    state.value = header.value;
+    state.restored = true;
+    munmap(mapped, bytes);
+
+    // Replay the tail in chunks
+    vector<LedgerRecord> chunk(4096);
+    uint64_t next = state.records;
+    while (next < inLedger) {
+        size_t want = static_cast<size_t>(min<uint64_t>(chunk.size(), inLedger - next));
+        ssize_t got = pread(fd, chunk.data(), want * sizeof(LedgerRecord), off_t(headerBytes + next * sizeof(LedgerRecord)));
+        if (got <= 0) break;
+        size_t k = 0;
+        for (; k < static_cast<size_t>(got) / sizeof(LedgerRecord); k++) {
+            const LedgerRecord& record = chunk[k];
+            if (record.seq != next + k || !intact(record) || record.slot >= static_cast<uint32_t>(tableSize)) break;
+            state.apply(record);
+        }
+        next += k;
+        if (k < want) break;
+    }
+    if (headerBytes + next * sizeof(LedgerRecord) != static_cast<uint64_t>(info.st_size)) {
+        if (ftruncate(fd, off_t(headerBytes + next * sizeof(LedgerRecord))) != 0) fatal("Cannot truncate ledger in " + dir);
+        fdatasync(fd);
+    }
+    pthread_mutex_lock(&lock);
+    appended = durable = restored = state.records;
+    pthread_mutex_unlock(&lock);
+}
+
+/**
+ * Queues records<br>
+ * --------------------------------------------------
+ * - Wakes the committer for the first record of a batch, and again once the batch is full.
+ * @param records Records to commit
+ */
+void Ledger::append(span<const LedgerRecord> records) {
+    if (records.empty()) return;
+    pthread_mutex_lock(&lock);
+    bool first = pending.empty();
+    pending.insert(pending.end(), records.begin(), records.end());
+    appended += records.size();
+    if (first || pending.size() >= batchLimit) pthread_cond_signal(&wake);
+    pthread_mutex_unlock(&lock);
+}
+
+/**
+ * Waits for durability<br>
+ * --------------------------------------------------
+ * - Cuts the current window short instead of waiting it out.
+ * @return false if a commit failed
+ */
+bool Ledger::sync() {
+    pthread_mutex_lock(&lock);
+    uint64_t target = appended;
+    if (durable < target) {
+        urgent = true;
+        pthread_cond_signal(&wake);
+    }
+    while (durable < target && !failed) pthread_cond_wait(&committed, &lock);
+    bool ok = !failed;
+    pthread_mutex_unlock(&lock);
+    return ok;
+}
+
+/**
+ * Writes a snapshot<br>
+ * --------------------------------------------------
+ * - Sized with ftruncate, filled through a shared mapping, flushed with msync,
+ *   then renamed over snapshot.bin and the directory synced so the rename lasts.
+ * @param state State to save
+ * @return true on success
+ */
+bool Ledger::snapshot(const LedgerState& state) {
+    string path = dir + "/snapshot.bin";
+    string temp = path + ".tmp";
+    size_t tableSize = state.ratings.size() / 3;
+    size_t kids = state.kidJobs.size();
+    size_t bytes = snapshotBytes(tableSize, kids);
+    int out = ::open(temp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) return false;
+    void* mapped = ftruncate(out, off_t(bytes)) == 0 ? mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, out, 0) : MAP_FAILED;
+    ::close(out);
+    if (mapped == MAP_FAILED) return false;
+
+    uint8_t* file = static_cast<uint8_t*>(mapped);
+    SnapshotHeader header{};
+    memcpy(header.magic, "TDSNAP01", 8);
+    header.version = 1;
+    header.tableSize = static_cast<uint32_t>(tableSize);
+    header.kids = static_cast<uint32_t>(kids);
+    header.records = state.records;
+    header.value = state.value;
+    memcpy(file + sizeof(header), state.ratings.data(), state.ratings.size());
+    int64_t* totals = reinterpret_cast<int64_t*>(file + sizeof(header) + ((tableSize * 3 + 7) & ~size_t(7)));
+    for (size_t k = 0; k < kids; k++) {
+        totals[2 * k] = state.kidJobs[k];
+        totals[2 * k + 1] = state.kidValue[k];
+    }
+    memcpy(file, &header, sizeof(header));
+    header.check = snapshotCheck(file, bytes);
+    memcpy(file, &header, sizeof(header));
+    bool ok = msync(mapped, bytes, MS_SYNC) == 0;
+    munmap(mapped, bytes);
+    if (!ok || rename(temp.c_str(), path.c_str()) != 0) return false;
+
+    int directory = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (directory >= 0) {
+        fsync(directory);
+        ::close(directory);
+    }
+    snapshots++;
+    return true;
+}
+
+/** Commits the pending records, joins the committer and closes ledger.bin */
+void Ledger::close() {
+    if (running) {
+        pthread_mutex_lock(&lock);
+        stopping = true;
+        pthread_cond_signal(&wake);
+        pthread_mutex_unlock(&lock);
+        pthread_join(committer, nullptr);
+        running = false;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+/**
+ * Prints the ledger's numbers<br>
+ * --------------------------------------------------
+ * @param out Stream to format into
+ */
+void Ledger::print(ostream& out) const {
+    out << fixed << setprecision(2) << "Ledger: " << durable - restored << " records committed in " << commits << " commits ("
+        << double(durable - restored) / max(commits, 1L) << " records per fdatasync, largest " << largestBatch << ", "
+        << syncNs / 1e6 / max(commits, 1L) << " ms per commit), " << snapshots << " snapshots"
+        << defaultfloat << setprecision(6);
+}
+
+/** Fills a record's checksum from its first 28 bytes */
+void Ledger::seal(LedgerRecord& record) {
+    record.check = static_cast<uint32_t>(fnv1a(&record, offsetof(LedgerRecord, check)));
+}
+
+/** @return true if the record's checksum matches its contents */
+bool Ledger::intact(const LedgerRecord& record) {
+    return record.check == static_cast<uint32_t>(fnv1a(&record, offsetof(LedgerRecord, check)));
+}
@@ -0,0 +1,146 @@
+#pragma once
+#include "tools.hpp"
+#include <cstdint>
+
+/**
+ * LedgerRecord struct<br>
+ * ------------------------------------------------------<br>
+ * - One completed job and the job Mom put in its slot, 32 bytes.<br>
+ * - seq numbers records from 0 with no gaps; check covers the bytes before it,
+ *   so a torn write at the end of the file is found and cut off on restore.<br>
+ */
+struct LedgerRecord {
+    uint64_t seq;          ///< Position in the ledger
+    uint32_t slot;         ///< Table slot
+    uint32_t kid;          ///< Kid that completed the job
+    uint8_t slow;          ///< Completed job's slow rating
+    uint8_t dirty;         ///< Completed job's dirty rating
+    uint8_t heavy;         ///< Completed job's heavy rating
+    uint8_t nextSlow;      ///< Slow rating of the job that replaced it
+    uint8_t nextDirty;     ///< Dirty rating of the job that replaced it
+    uint8_t nextHeavy;     ///< Heavy rating of the job that replaced it
+    uint16_t reserved;     ///< Zero
+    int32_t value;         ///< Completed job's value
+    uint32_t check;        ///< Checksum of the first 28 bytes
+};
+static_assert(sizeof(LedgerRecord) == 32, "LedgerRecord must stay 32 bytes");
+
+/**
+ * LedgerState struct<br>
+ * ------------------------------------------------------<br>
+ * - What a snapshot holds: the table's jobs and the completions so far,
+ *   in total and per kid, as of a ledger position.<br>
+ * - Mom keeps one up to date as she appends, and restore() rebuilds one
+ *   from the latest snapshot plus the ledger records after it.<br>
+ */
+struct LedgerState {
+    vector<uint8_t> ratings;     ///< Slow, dirty and heavy of the job in each slot
+    vector<int64_t> kidJobs;     ///< Jobs completed per kid id
+    vector<int64_t> kidValue;    ///< Value earned per kid id
+    uint64_t records = 0;        ///< Ledger records covered, also the next seq
+    int64_t value = 0;           ///< Value of every completion covered
+    bool restored = false;       ///< True if ratings came from a snapshot
+
+    /** Counts a completion<br>
+     * @param record Ledger record of the completion
+     */
+    void apply(const LedgerRecord& record);
+};
+
+/**
+ * Ledger class<br>
+ * ------------------------------------------------------<br>
+ * - Write-ahead ledger of completed jobs plus table snapshots, in one directory:
+ *   ledger.bin is append-only, snapshot.bin is replaced whole.<br>
+ * - Group commit: Mom appends records to a buffer, and a committer thread writes
+ *   everything buffered with one write and one fdatasync per commit window.
+ *   A crash loses at most the completions of the last window.<br>
+ * - A snapshot is filled through a memory mapping of snapshot.bin.tmp, synced,
+ *   and renamed over snapshot.bin, so the previous one stays valid until then.
+ *   Mom syncs the ledger first, so a snapshot never covers records the ledger lost.<br>
+ * - restore() reads the snapshot and replays the records after it.<br>
+ */
+class Ledger {
+private:
+    string dir;                      ///< Directory holding ledger.bin and snapshot.bin
+    int fd = -1;                     ///< ledger.bin, opened for appending
+    long commitMicros = 0;           ///< Group commit window
+    pthread_t committer{};
+    bool running = false;            ///< True while the committer thread runs
+    pthread_mutex_t lock{};
+    pthread_cond_t wake{};           ///< Signalled on the first record of a batch, sync() and close()
+    pthread_cond_t committed{};      ///< Broadcast after each fdatasync
+    vector<LedgerRecord> pending;    ///< Appended, not yet written
+    vector<LedgerRecord> writing;    ///< Batch being written by the committer
+    uint64_t appended = 0;           ///< Records handed to append()
+    uint64_t durable = 0;            ///< Records written and synced
+    uint64_t restored = 0;           ///< Records already in the ledger when it was opened
+    bool urgent = false;             ///< A sync() is waiting; commit without waiting out the window
+    bool stopping = false;
+    bool failed = false;             ///< A write or fdatasync failed; nothing more is durable
+    long commits = 0;                ///< fdatasync calls that committed records
+    uint64_t syncNs = 0;             ///< Time spent in write and fdatasync
+    size_t largestBatch = 0;         ///< Most records one commit held
+    long snapshots = 0;              ///< Snapshots written
+
+    /** Committer loop: waits for records, lets the window pass, writes and syncs the batch */
+    void commitLoop();
+
+    static void* committerMain(void* arg);
+
+public:
+    static constexpr size_t batchLimit = 8192;   ///< Records that start a commit before the window ends
+    static constexpr size_t headerBytes = 16;    ///< Bytes before the first record of ledger.bin
+
+    Ledger();
+    ~Ledger();
+
+    Ledger(const Ledger&) = delete;
+    Ledger& operator=(const Ledger&) = delete;
+
+    /** Opens the ledger in a directory, creating both if missing, and starts the committer<br>
+     * @param directory Ledger directory
+     * @param commitWindowMicros Microseconds a commit waits for more records
+     * @return false if the directory or ledger.bin cannot be used
+     */
+    bool open(const string& directory, long commitWindowMicros);
+
+    /** Rebuilds the state of the previous run<br>
+     * Reads snapshot.bin, then replays the ledger records after it; a torn or
+     * corrupt tail is cut off. Exits through fatal() if the snapshot was taken
+     * with another table size, or the ledger has records but no snapshot.
+     * @param tableSize Config::tableSize of this run
+     * @param kids Config::kids of this run
+     * @param state Receives the state; restored stays false when there is nothing to restore
+     */
+    void restore(int tableSize, int kids, LedgerState& state);
+
+    /** Queues records for the next commit; Mom only<br>
+     * @param records Records numbered from the previous append's last seq + 1
+     */
+    void append(span<const LedgerRecord> records);
+
+    /** Blocks until every appended record is durable<br>
+     * @return false if a write failed
+     */
+    bool sync();
+
+    /** Writes a snapshot of the state and replaces snapshot.bin with it<br>
+     * Call after sync(), so the ledger holds every record the state covers.
+     * @param state State to save
+     * @return false if the snapshot could not be written
+     */
+    bool snapshot(const LedgerState& state);
+
+    /** Commits what is left and stops the committer */
+    void close();
+
+    /** Prints records, commits, records per commit and sync time */
+    void print(ostream& out) const;
+
+    /** Fills a record's checksum */
+    static void seal(LedgerRecord& record);
+
+    /** True if a record's checksum matches */
+    static bool intact(const LedgerRecord& record);
+};
@@ -0,0 +1,186 @@
+#include "Metrics.hpp"
+#include <cstdio>
+#include <mutex>
+
+/** Registry state, touched only by attach and export */
+namespace {
+    mutex registryLock;
+    vector<unique_ptr<ThreadMetrics>> registry;
+    string outputPrefix;
+    bool on = false;
+    uint64_t startNs = 0;
+    uint64_t lastExportNs = 0;
+}
+
+/**
+ * Quantile lookup<br>
+ * --------------------------------------------------
+ * - Walks the buckets until the running count reaches q of the total.
+ * @param q Quantile in [0, 1]
+ * @return Lower bound of the bucket, or 0 when nothing was recorded
+ */
+uint64_t Histogram::percentile(double q) const {
+    uint64_t n = count();
+    if (n == 0) return 0;
+    uint64_t rank = max<uint64_t>(1, static_cast<uint64_t>(ceil(q * n)));
+    uint64_t seen = 0;
+    for (int b = 0; b < buckets; b++) {
+        seen += counts[b].load(memory_order_relaxed);
+        if (seen >= rank) return lowerBound(b);
+    }
+    return maxNs();
+}
+
+/**
+ * Histogram merge<br>
+ * --------------------------------------------------
+ * - Bucket by bucket, so the merged quantiles are as exact as the inputs'.
+ * @param other Histogram to add
+ */
+void Histogram::add(const Histogram& other) {
+    for (int b = 0; b < buckets; b++) bump(counts[b], other.counts[b].load(memory_order_relaxed));
+    bump(total, other.count());
+    bump(sum, other.totalNs());
+    if (other.maxNs() > maxNs()) largest.store(other.maxNs(), memory_order_relaxed);
+}
+
+/**
+ * Enables metrics<br>
+ * --------------------------------------------------
+ * - Without DISPATCHER_METRICS this only warns, since nothing is instrumented.
+ * @param prefix Output path prefix
+ */
+void Metrics::enable(const string& prefix) {
+#ifdef DISPATCHER_METRICS
+    lock_guard<mutex> guard(registryLock);
+    outputPrefix = prefix;
+    on = true;
+    startNs = lastExportNs = now();
+#else
+    cerr << "Metrics were compiled out (DISPATCHER_METRICS=OFF); " << prefix << " will not be written" << endl;
+#endif
+}
+
+/** @return true once metrics are enabled */
+bool Metrics::enabled() {
+    lock_guard<mutex> guard(registryLock);
+    return on;
+}
+
+/**
+ * Attaches the calling thread<br>
+ * --------------------------------------------------
+ * @param thread Export name of the thread
+ */
+void Metrics::attach(const string& thread) {
+    lock_guard<mutex> guard(registryLock);
+    if (!on) return;
+    registry.push_back(make_unique<ThreadMetrics>(thread));
+    current = registry.back().get();
+}
+
+/** Quantiles exported for every histogram, and their JSON labels */
+static const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+static const string quantileLabels[] = {"p50", "p90", "p99", "p999"};
+
+/**
+ * Writes one file atomically<br>
+ * --------------------------------------------------
+ * - Scrapers never see a half-written file: the text goes to path.tmp first.
+ * @param path Final path
+ * @param text File contents
+ */
+static void replaceFile(const string& path, const string& text) {
+    string temp = path + ".tmp";
+    ofstream out(temp, ios::out | ios::trunc);
+    out << text;
+    out.close();
+    if (!out || rename(temp.c_str(), path.c_str()) != 0) cerr << "Cannot write metrics file " << path << endl;
+}
+
+/**
+ * Exports every thread's metrics<br>
+ * --------------------------------------------------
+ * - JSON: one object per thread with jobs, jobs/sec since the previous export
+ *   and count, mean, p50/p90/p99/p999 and max per histogram, in nanoseconds.
+ * - Prometheus text format: a summary per histogram in seconds, labelled by
+ *   thread, plus a jobs counter.
+ */
+void Metrics::exportFiles() {
+    lock_guard<mutex> guard(registryLock);
+    if (!on || outputPrefix.empty()) return;
+    uint64_t at = now();
+    double interval = max(1e-9, (at - lastExportNs) / 1e9);
+    lastExportNs = at;
+
+    stringstream json, prom;
+    json << fixed << setprecision(3) << "{\"uptime_s\": " << (at - startNs) / 1e9 << ", \"threads\": [";
+    for (size_t t = 0; t < registry.size(); t++) {
+        ThreadMetrics& thread = *registry[t];
+        uint64_t jobs = thread.jobs.load(memory_order_relaxed);
+        json << (t ? ", " : "") << "{\"thread\": \"" << thread.thread << "\", \"jobs\": " << jobs
+             << ", \"jobs_per_sec\": " << (jobs - thread.lastJobs) / interval;
+        thread.lastJobs = jobs;
+        for (int m = 0; m < static_cast<int>(Metric::COUNT); m++) {
+            const Histogram& h = thread.histograms[m];
+            json << ", \"" << metricName[m] << "\": {\"count\": " << h.count()
+                 << ", \"mean_ns\": " << (h.count() ? double(h.totalNs()) / h.count() : 0.0);
+            for (int q = 0; q < 4; q++) json << ", \"" << quantileLabels[q] << "_ns\": " << h.percentile(quantiles[q]);
+            json << ", \"max_ns\": " << h.maxNs() << "}";
+        }
+        json << "}";
+    }
+    json << "]}\n";
+
+    prom << setprecision(9);
+    for (int m = 0; m < static_cast<int>(Metric::COUNT); m++) {
+        string name = "dispatcher_" + metricName[m] + "_seconds";
+        prom << "# HELP " << name << " Time per " << metricName[m] << " section\n# TYPE " << name << " summary\n";
+        for (const unique_ptr<ThreadMetrics>& thread : registry) {
+            const Histogram& h = thread->histograms[m];
+            for (double q : quantiles) {
+                prom << name << "{thread=\"" << thread->thread << "\",quantile=\"" << q << "\"} " << h.percentile(q) / 1e9 << "\n";
+            }
+            prom << name << "_sum{thread=\"" << thread->thread << "\"} " << h.totalNs() / 1e9 << "\n";
+            prom << name << "_count{thread=\"" << thread->thread << "\"} " << h.count() << "\n";
+        }
+    }
+    prom << "# HELP dispatcher_jobs_total Jobs completed\n# TYPE dispatcher_jobs_total counter\n";
+    for (const unique_ptr<ThreadMetrics>& thread : registry) {
+        prom << "dispatcher_jobs_total{thread=\"" << thread->thread << "\"} " << thread->jobs.load(memory_order_relaxed) << "\n";
+    }
+
+    replaceFile(outputPrefix + ".json", json.str());
+    replaceFile(outputPrefix + ".prom", prom.str());
+}
+
+/** @return Sum of every thread's completed-job counter */
+uint64_t Metrics::totalJobs() {
+    lock_guard<mutex> guard(registryLock);
+    uint64_t jobs = 0;
+    for (const unique_ptr<ThreadMetrics>& thread : registry) jobs += thread->jobs.load(memory_order_relaxed);
+    return jobs;
+}
+
+/**
+ * Merges a metric across threads<br>
+ * --------------------------------------------------
+ * @param metric Section to merge
+ * @param into Receives every thread's values
+ */
+void Metrics::merge(Metric metric, Histogram& into) {
+    lock_guard<mutex> guard(registryLock);
+    for (const unique_ptr<ThreadMetrics>& thread : registry) into.add(thread->histograms[static_cast<int>(metric)]);
+}
+
+/**
+ * Clears the registry<br>
+ * --------------------------------------------------
+ * - Lets one process measure several runs apart, as the benchmark suite does.
+ */
+void Metrics::reset() {
+    lock_guard<mutex> guard(registryLock);
+    registry.clear();
+    current = nullptr;
+    startNs = lastExportNs = now();
+}
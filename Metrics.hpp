@@ -0,0 +1,187 @@
+#pragma once
+#include "tools.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+/** Timed sections, one histogram each per thread */
+enum class Metric : uint8_t {
+    CLAIM, LOCK_WAIT, IDLE, ANNOUNCE, REFILL, COUNT
+    };
+
+const string metricName[]={"claim", "lock_wait", "idle", "announce", "refill"};
+
+/**
+ * Histogram class<br>
+ * ------------------------------------------------------<br>
+ * - Log-linear latency histogram in nanoseconds, HDR style: values below 16
+ *   get their own bucket, above that each power of two is split into 16,
+ *   so any recorded value is within 1/16 of its bucket's lower bound.<br>
+ * - Written by one thread only, with relaxed load-then-store instead of
+ *   read-modify-write, so recording costs the same as plain increments;
+ *   the exporter may read it at any time.<br>
+ */
+class Histogram {
+public:
+    static constexpr int subBits = 4;                            ///< log2 of buckets per power of two
+    static constexpr int buckets = (64 - subBits + 1) << subBits; ///< Enough for any uint64_t
+
+private:
+    atomic<uint64_t> counts[buckets]{};
+    atomic<uint64_t> total{0};
+    atomic<uint64_t> sum{0};
+    atomic<uint64_t> largest{0};
+
+    static void bump(atomic<uint64_t>& cell, uint64_t by) { cell.store(cell.load(memory_order_relaxed) + by, memory_order_relaxed); }
+
+public:
+    /** Maps a value to its bucket */
+    static int bucketOf(uint64_t ns) {
+        if (ns < (1u << subBits)) return static_cast<int>(ns);
+        int msb = 63 - __builtin_clzll(ns);
+        return ((msb - subBits + 1) << subBits) + static_cast<int>((ns >> (msb - subBits)) & ((1u << subBits) - 1));
+    }
+
+    /** Smallest value that maps to a bucket */
+    static uint64_t lowerBound(int bucket) {
+        if (bucket < (1 << subBits)) return bucket;
+        int msb = (bucket >> subBits) + subBits - 1;
+        return (uint64_t((1 << subBits) + (bucket & ((1 << subBits) - 1)))) << (msb - subBits);
+    }
+
+    /** Records one value; owner thread only */
+    void record(uint64_t ns) {
+        bump(counts[bucketOf(ns)], 1);
+        bump(total, 1);
+        bump(sum, ns);
+        if (ns > largest.load(memory_order_relaxed)) largest.store(ns, memory_order_relaxed);
+    }
+
+    /** Number of recorded values */
+    uint64_t count() const { return total.load(memory_order_relaxed); }
+
+    /** Sum of recorded values */
+    uint64_t totalNs() const { return sum.load(memory_order_relaxed); }
+
+    /** Largest recorded value */
+    uint64_t maxNs() const { return largest.load(memory_order_relaxed); }
+
+    /** Adds another histogram's values to this one; owner thread only<br>
+     * @param other Histogram to read, which may still be recording
+     */
+    void add(const Histogram& other);
+
+    /** Value at a quantile, as the lower bound of the bucket holding it<br>
+     * @param q Quantile in [0, 1]
+     */
+    uint64_t percentile(double q) const;
+};
+
+/**
+ * ThreadMetrics struct<br>
+ * ------------------------------------------------------<br>
+ * - Everything one thread records: a histogram per Metric and a completed-job counter.<br>
+ * - Owned by the Metrics registry and only freed by Metrics::reset().<br>
+ */
+struct ThreadMetrics {
+    string thread;                                           ///< Kid name, or "mom"
+    Histogram histograms[static_cast<int>(Metric::COUNT)];  ///< One per Metric
+    atomic<uint64_t> jobs{0};                                ///< Jobs this thread completed
+    uint64_t lastJobs = 0;                                   ///< Exporter's previous reading of jobs
+
+    explicit ThreadMetrics(const string& thread): thread(thread) {}
+};
+
+/**
+ * Metrics class<br>
+ * ------------------------------------------------------<br>
+ * - Registry of per-thread buffers plus the JSON and Prometheus exporters.<br>
+ * - A thread records only after attach(); until then, and in builds without
+ *   DISPATCHER_METRICS, recording does nothing.<br>
+ * - Hot-path calls touch only the calling thread's buffer; attach and export take a lock.<br>
+ */
+class Metrics {
+private:
+    static inline thread_local ThreadMetrics* current = nullptr;   ///< Calling thread's buffer
+
+public:
+    /** Reads the clock used for every timing */
+    static uint64_t now() {
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /** Turns recording on for the process<br>
+     * @param prefix Files are written to prefix.json and prefix.prom; empty to record without exporting
+     */
+    static void enable(const string& prefix);
+
+    /** True once enable() has been called */
+    static bool enabled();
+
+    /** Gives the calling thread its own buffer, if metrics are enabled<br>
+     * @param thread Name the thread is exported under
+     */
+    static void attach(const string& thread);
+
+    /** Records a duration for the calling thread<br>
+     * @param metric Section that was timed
+     * @param start Value of now() when it began
+     */
+    static void record(Metric metric, uint64_t start) {
+        if (current != nullptr) current->histograms[static_cast<int>(metric)].record(now() - start);
+    }
+
+    /** Counts a completed job for the calling thread */
+    static void jobDone() {
+        if (current != nullptr) current->jobs.store(current->jobs.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    }
+
+    /** True if the calling thread records, so callers can skip reading the clock */
+    static bool recording() { return current != nullptr; }
+
+    /** Writes prefix.json and prefix.prom, each through a temporary file and rename */
+    static void exportFiles();
+
+    /** Returns the jobs completed by every attached thread */
+    static uint64_t totalJobs();
+
+    /** Merges one Metric across every attached thread<br>
+     * @param metric Section to merge
+     * @param into Histogram the values are added to
+     */
+    static void merge(Metric metric, Histogram& into);
+
+    /** Drops every thread's buffer, so the next run starts from zero<br>
+     * Only call once the threads that attached have exited; the caller is detached.
+     */
+    static void reset();
+};
+
+/**
+ * ScopedTimer class<br>
+ * ------------------------------------------------------<br>
+ * - Records the time from construction to destruction under one Metric.<br>
+ * - Reads the clock only when the thread is attached.<br>
+ */
+class ScopedTimer {
+private:
+    Metric metric;
+    uint64_t start;
+
+public:
+    explicit ScopedTimer(Metric metric): metric(metric), start(Metrics::recording() ? Metrics::now() : 0) {}
+    ~ScopedTimer() { if (start != 0) Metrics::record(metric, start); }
+};
+
+// Instrumentation points; they vanish when the build is configured with -DDISPATCHER_METRICS=OFF
+#ifdef DISPATCHER_METRICS
+#define METRICS_CONCAT2(a, b) a##b
+#define METRICS_CONCAT(a, b) METRICS_CONCAT2(a, b)
+#define METRICS_SCOPE(metric) ScopedTimer METRICS_CONCAT(metricsTimer, __LINE__)(metric)
+#define METRICS_LOCK(mutex) do { ScopedTimer lockTimer(Metric::LOCK_WAIT); pthread_mutex_lock(mutex); } while (0)
+#define METRICS_JOB_DONE() Metrics::jobDone()
+#else
+#define METRICS_SCOPE(metric) ((void)0)
+#define METRICS_LOCK(mutex) pthread_mutex_lock(mutex)
+#define METRICS_JOB_DONE() ((void)0)
+#endif
@@ -1,5 +1,14 @@
 #include "Mom.hpp"
 #include "Printer.hpp"
+#include "EventLog.hpp"
+#include "Random.hpp"
+#include "Metrics.hpp"
+#include "Tracer.hpp"
+#include "Topology.hpp"
+#include <chrono>
+#include <queue>
+#include <tuple>
+#include <sys/wait.h>
 
 /**
  * Thread entry function for Kid threads. <br>
@@ -12,45 +21,288 @@ void* kidMain(void* k) {
 }
 
 /**
- * Mom Destructor <br>
+ * Rate over a run. <br>
+ * Runs that end early on --input can last well under a second, so the time <br>
+ * is used as it is; only a run of no time at all reports 0. <br>
+ * @param count Jobs, claims or value over the run
+ * @param seconds Length of the run
+ * @return count per second
+ */
+static double perSecond(double count, double seconds) {
+    return seconds > 0 ? count / seconds : 0;
+}
+
+/**
+ * Mom Constructor <br>
  * --------------------------------------------------<br>
- * Cleans up by deallocating all dynamically allocated completed jobs.
+ * Stores the startup options and picks the table's scheduling mode.
+ * @param config Parsed command line options
  */
-Mom::~Mom() {
-    for (Job* job : completedJobs) delete job;
+Mom::Mom(const Config& config): config(config) {
+    table.mode = config.schedule;
+    table.batch = config.batch;
+    table.tick = config.tick;
+    table.aging = config.aging;
+    table.simulated = config.clock == ClockMode::VIRTUAL;
+    table.quiet = config.quiet;
+    table.jobs.assign(config.tableSize, JobHandle{});
+    table.scores.resize(config.kids);
+    if (config.deps > 0) recentJobs.assign(config.tableSize, JobHandle{});
+    if (config.schedule == SchedMode::SCAN) table.columns.resize(config.tableSize);
+    if (!config.inputFile.empty()) {
+        source = make_unique<JobSource>();
+        if (!source->open(config.inputFile, config.tableSize)) fatal("Cannot read jobs from " + config.inputFile);
+    }
+    if (!config.ledgerDir.empty()) {
+        ledger = make_unique<Ledger>();
+        if (!ledger->open(config.ledgerDir, config.commitMillis * 1000L)) fatal("Cannot open a ledger in " + config.ledgerDir);
+    }
+    if (config.shards > 1) {
+        // Shards are dealt to the NUMA nodes in turn
+        const vector<Topology::Node>& nodes = Topology::nodes();
+        vector<int> shardNodes;
+        for (int s = 0; s < config.shards; s++) shardNodes.push_back(nodes[s % nodes.size()].id);
+        table.split(shardNodes);
+    }
 }
 
 /**
- * Initializes the shared JobTable with 10 random jobs. <br>
- * Each job is dynamically allocated and stored in the table. <br>
- * Job information is printed to both the terminal and output file.
+ * Chooses a kid's home shard. <br>
+ * A pinned kid gets a shard on its CPU's node, kids sharing a node taking its <br>
+ * shards in turn; unpinned kids, or kids on a node without a shard, are dealt <br>
+ * to all shards in turn. <br>
+ * @param kid Kid index
+ * @param cpu The kid's CPU, or -1
+ * @return Shard index
+ */
+int Mom::homeShard(int kid, int cpu) const {
+    int count = static_cast<int>(table.shards.size());
+    if (cpu >= 0) {
+        int node = Topology::nodeOf(cpu);
+        vector<int> local;
+        for (int s = 0; s < count; s++) {
+            if (table.shards[s]->node == node) local.push_back(s);
+        }
+        if (!local.empty()) return local[kid % local.size()];
+    }
+    return kid % count;
+}
+
+/**
+ * Pins a kid thread. <br>
+ * A refused CPU is reported and the kid left unpinned. <br>
+ * @param kid Kid index
+ * @param thread Its thread
+ */
+void Mom::pinKid(int kid, pthread_t thread) {
+    if (config.pinCpus.empty()) return;
+    int cpu = config.pinCpus[kid % config.pinCpus.size()];
+    if (Topology::pin(thread, cpu)) return;
+    ss << "Could not pin " << Kid::makeName(kid) << " to CPU " << cpu << endl;
+    Printer::write(ss, cout);
+}
+
+/**
+ * Initializes every slot of the shared JobTable with a random job. <br>
+ * Each job is taken from the table's JobPool, from the lane of the slot's shard, <br>
+ * and its handle stored in the slot; shards are filled one at a time under their lock. <br>
+ * Job information is printed to both the terminal and output file, <br>
+ * unless the table is too large for a per-job listing to be useful. <br>
+ * In binary log mode every job is recorded as a JOB_POSTED event instead. <br>
+ * A run resuming from a ledger posts the jobs its snapshot and records left in each slot. <br>
+ * With --input the jobs come from the input, and slots it has no jobs for stay empty.
  */
 void Mom::initializeJobTable() {
-    pthread_mutex_lock(&table.lock);
-    for (int i = 0; i < 10; i++) {
-        Job* newJob = new Job;
-        table.jobs[i] = newJob;
-        ss << "Job" << i << endl;
-        Printer::write(ss, cout);
-        ss << *newJob << endl;
+    const int listLimit = 100;
+    int size = static_cast<int>(table.jobs.size());
+    int filled = size;
+    if (ledgerState.restored) ratings = ledgerState.ratings;
+    else filled = static_cast<int>(nextRatings(size));
+    if (ledger) ledgerState.ratings = ratings;
+    for (int i = 0; i < size; i++) {
+        int shard = i / table.shardSlots;
+        if (i % table.shardSlots == 0) pthread_mutex_lock(&table.shards[shard]->lock);
+        if (i < filled) {
+            table.jobs[i] = table.pool.acquireOn(shard, ratings[3 * i], ratings[3 * i + 1], ratings[3 * i + 2]);
+            Job* newJob = table.at(i);
+            if (prepareJob(i)) table.post(i);
+            if (EventLog::enabled()) {
+                EventLog::record(EventType::JOB_POSTED, EventLog::momId, i, newJob);
+            } else if (size <= listLimit) {
+                ss << "Job" << i << endl;
+                Printer::write(ss, cout);
+                ss << *newJob << endl;
+                Printer::write(ss, cout);
+            }
+        } else {
+            emptySlots++;
+        }
+        if (i % table.shardSlots == table.shardSlots - 1 || i == size - 1) pthread_mutex_unlock(&table.shards[shard]->lock);
+    }
+    if (size > listLimit || EventLog::enabled()) {
+        ss << filled << " jobs posted" << endl;
         Printer::write(ss, cout);
     }
-    pthread_mutex_unlock(&table.lock);
 }
 
 /**
  * Scans the JobTable for completed jobs. <br>
- * If a job is marked COMPLETE, it's saved in the completed list and replaced with a new job.
+ * Only the slots kids queued in announceDone are visited, shard by shard. <br>
+ * A shard's queue is taken under its lock, which is then dropped while the <br>
+ * ratings are filled, so kids are never held up by a wait for --input jobs. <br>
+ * Each completed job's record is saved in the completed list and the slot gets a new job <br>
+ * from its shard's JobPool lane, so a shard's jobs stay in its node's memory; the <br>
+ * completed job then goes back to the pool, and the next refill reuses its slot. <br>
+ * Once the --input jobs run out, a freed slot is left empty instead. <br>
+ * The new job is posted to the ready buckets so kids can claim it without scanning. <br>
+ * Refills are printed, or recorded as JOB_REFILLED events in binary log mode, <br>
+ * and skipped entirely when the table is quiet. <br>
+ * With a ledger, each refill becomes a record naming the completed job and its <br>
+ * replacement, appended once per pass so the committer syncs them together. <br>
+ * When tracing, a pass that refilled anything is a refill slice on Mom's track.
  */
 void Mom::scanJobTable() {
-    for (int i = 0; i < 10; i++) {
-        if (table.jobs[i]->status == JobStatus::COMPLETE) {
-            completedJobs.push_back(table.jobs[i]);
-            table.jobs[i] = new Job();
-            ss << "Adding new job at index: " << i << endl;
-            Printer::write(ss, cout);
+    METRICS_SCOPE(Metric::REFILL);
+    uint64_t start = Tracer::recording() ? Metrics::now() : 0;
+    vector<int> refilled;
+    for (size_t s = 0; s < table.shards.size(); s++) {
+        JobTable::Shard& shard = *table.shards[s];
+        size_t first = refilled.size();
+        METRICS_LOCK(&shard.lock);
+        refilled.insert(refilled.end(), shard.doneSlots.begin(), shard.doneSlots.end());
+        shard.doneSlots.clear();
+        pthread_mutex_unlock(&shard.lock);
+        if (refilled.size() == first) continue;
+        // The input reader may keep Mom waiting here, so the shard stays unlocked
+        size_t fresh = nextRatings(refilled.size() - first);
+        METRICS_LOCK(&shard.lock);
+        for (size_t k = 0; first + k < refilled.size(); k++) {
+            int i = refilled[first + k];
+            JobHandle doneHandle = table.jobs[i];
+            CompletedJob done = table.pool.get(doneHandle)->summary();
+            recordCompletion(done);
+            if (k >= fresh) {
+                table.jobs[i] = JobHandle{};
+                table.pool.release(doneHandle);
+                emptySlots++;
+                continue;
+            }
+            table.jobs[i] = table.pool.acquireOn(static_cast<int>(s), ratings[3 * k], ratings[3 * k + 1], ratings[3 * k + 2]);
+            table.pool.release(doneHandle);
+            if (ledger) {
+                LedgerRecord record{ledgerState.records + ledgerBatch.size(), static_cast<uint32_t>(i), static_cast<uint32_t>(done.kidId),
+                                    static_cast<uint8_t>(done.slow), static_cast<uint8_t>(done.dirty), static_cast<uint8_t>(done.heavy),
+                                    ratings[3 * k], ratings[3 * k + 1], ratings[3 * k + 2], 0, done.value, 0};
+                Ledger::seal(record);
+                ledgerBatch.push_back(record);
+            }
+            if (prepareJob(i)) table.post(i);
+        }
+        pthread_mutex_unlock(&shard.lock);
+    }
+    if (!ledgerBatch.empty()) {
+        for (const LedgerRecord& record : ledgerBatch) ledgerState.apply(record);
+        ledger->append(ledgerBatch);
+        ledgerBatch.clear();
+    }
+    if (start != 0 && !refilled.empty()) Tracer::record(TraceSpan::REFILL, start, Tracer::momTrack, -1, static_cast<int>(refilled.size()));
+
+    for (int i : refilled) {
+        if (!table.jobs[i].valid()) continue;
+        if (EventLog::enabled()) {
+            EventLog::record(EventType::JOB_REFILLED, EventLog::momId, i, table.at(i));
+            continue;
         }
+        if (table.quiet) continue;
+        ss << "Adding new job at index: " << i << endl;
+        Printer::write(ss, cout);
+    }
+}
+
+/**
+ * Counts a collected job. <br>
+ * The task result goes into the checksum now; the record itself is only kept <br>
+ * for the per-job summary, so a quiet run's memory does not grow with its jobs. <br>
+ * @param done The job's record
+ */
+void Mom::recordCompletion(const CompletedJob& done) {
+    jobsCompleted++;
+    if (done.hasResult) {
+        resultChecksum ^= static_cast<uint64_t>(done.result);
+        taskResults++;
     }
+    if (!table.quiet) completedJobs.push_back(done);
+}
+
+/**
+ * Rolls slow, dirty and heavy ratings for a batch of new jobs. <br>
+ * One bulk fill from Mom's stream replaces three random calls per job. <br>
+ * @param count Number of jobs; ratings[3k..3k+2] belong to job k
+ */
+void Mom::rollRatings(size_t count) {
+    ratings.resize(3 * count);
+    Rng::local().fill(ratings.data(), ratings.size(), 1, 5);
+}
+
+/**
+ * Fills ratings for the next jobs. <br>
+ * Mom waits here when the input reader has fallen behind. <br>
+ * @param count Number of jobs; ratings[3k..3k+2] belong to job k
+ * @return Jobs filled
+ */
+size_t Mom::nextRatings(size_t count) {
+    if (!source) {
+        rollRatings(count);
+        return count;
+    }
+    ratings.resize(3 * count);
+    return source->take(ratings.data(), count);
+}
+
+/**
+ * Takes a snapshot. <br>
+ * Waits for the ledger to hold every record appended so far, so the snapshot <br>
+ * never covers completions a crash could still lose. <br>
+ */
+void Mom::takeSnapshot() {
+    if (!ledger->sync() || !ledger->snapshot(ledgerState)) cerr << "Cannot write a snapshot in " << config.ledgerDir << endl;
+}
+
+/**
+ * Time since the kids were started. <br>
+ * Reads CLOCK_REALTIME, the clock waitForCompletions' deadlines use; <br>
+ * time() can lag it by a tick, which would make Mom spin until it caught up. <br>
+ * @return Seconds since startTime, with the fraction
+ */
+double Mom::secondsRunning() {
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    currentTime = now.tv_sec;
+    return difftime(now.tv_sec, startTime.tv_sec) + (now.tv_nsec - startTime.tv_nsec) / 1e9;
+}
+
+/**
+ * Prints one live leaderboard line. <br>
+ * Reads the table's Leaderboard while kids keep working. <br>
+ * @param at Seconds into the run, real or simulated
+ */
+void Mom::printLeaderboard(long at) {
+    ss << "Leaderboard at " << at << " s: ";
+    table.scores.print(ss);
+    ss << endl;
+    Printer::write(ss, cout);
+}
+
+/**
+ * Waits on the table's done semaphore. <br>
+ * Returns immediately if completed slots were queued since the last wait. <br>
+ * The semaphore is drained before Mom scans, so a slot queued during the scan <br>
+ * leaves a count behind and the next wait returns at once instead of missing it.
+ * @param deadline Absolute time at which to stop waiting
+ */
+void Mom::waitForCompletions(const timespec& deadline) {
+    while (sem_timedwait(&table.done, &deadline) != 0 && errno == EINTR) {}
+    while (sem_trywait(&table.done) == 0) {}
 }
 
 /**
@@ -62,93 +314,770 @@ void Mom::print() {
 }
 
 /**
- * Main control logic for the Mom thread. <br>
+ * Real-time run. <br>
  * --------------------------------------------------
- * - Prints welcome message
- * - Initializes jobs and spawns kid threads
- * - Signals all kids to begin work
- * - Waits for 21 seconds, polling for completed jobs
- * - Sends termination signal to each kid
- * - Joins all threads and prints summary results
+ * - Spawns the kids and starts them, by signal or through a start latch
+ * - Runs for Config::duration seconds, refilling as soon as a kid announces a completed job
+ * - Prints the live leaderboard every Config::leaderboardEvery seconds
+ * - Exports metrics every second when they are on
+ * - Snapshots the table every Config::snapshotEvery seconds when there is a ledger
+ * - Ends early once every --input job is done
+ * - Stops the kids, joins them and takes back jobs they reserved but never started
+ * - Reports how long kids took to be released and to claim their first job
+ * @return Seconds the kids worked for: whole seconds for a full run, the exact time for one that ended early
  */
-void Mom::run() {
-    print();
-    initializeJobTable();
-    ss << "Job Table Initialized" << endl;
+double Mom::supervise() {
+    latch ready(config.kids);
+    latch start(1);
+    if (config.pool > 0) startWithScheduler();
+    else if (config.control == ControlMode::TOKEN) startWithLatch(ready, start);
+    else startWithSignals();
+
+    // Full resolution: a whole-second start would cut the first second short
+    clock_gettime(CLOCK_REALTIME, &startTime);
+
+    // Run simulation for the configured duration, waking on each completion,
+    // whenever a live leaderboard line is due and once a second to export metrics
+    long nextBoard = config.leaderboardEvery;
+    bool exporting = Metrics::enabled();
+    long nextExport = 1;
+    bool snapshotting = ledger && config.snapshotEvery > 0;
+    long nextSnapshot = config.snapshotEvery;
+    while (secondsRunning() < config.duration) {
+        long wakeAt = config.duration;
+        if (config.leaderboardEvery > 0) wakeAt = min(wakeAt, nextBoard);
+        if (exporting) wakeAt = min(wakeAt, nextExport);
+        if (snapshotting) wakeAt = min(wakeAt, nextSnapshot);
+        waitForCompletions({startTime.tv_sec + wakeAt, startTime.tv_nsec});
+        scanJobTable();
+        double now = secondsRunning();
+        if (config.leaderboardEvery > 0 && now >= nextBoard) {
+            printLeaderboard(nextBoard);
+            nextBoard += config.leaderboardEvery;
+        }
+        if (exporting && now >= nextExport) {
+            Metrics::exportFiles();
+            nextExport = static_cast<long>(now) + 1;
+        }
+        if (snapshotting && now >= nextSnapshot) {
+            takeSnapshot();
+            nextSnapshot += config.snapshotEvery;
+        }
+        if (emptySlots == config.tableSize) {
+            ss << "Every input job is done after " << fixed << setprecision(2) << now << " s" << defaultfloat << setprecision(6) << endl;
+            Printer::write(ss, cout);
+            break;
+        }
+    }
+    double elapsed = emptySlots == config.tableSize ? secondsRunning() : floor(secondsRunning());
+
+    if (config.pool > 0) stopWithScheduler();
+    else if (config.control == ControlMode::TOKEN) stopWithTokens();
+    else stopWithSignals();
+
+    // Jobs a kid reserved but was stopped before starting go back on the table
+    for (Kid& kid : kids) kid.returnReserved();
+    reportStartLatency();
+    if (config.pool > 0) reportCoroutineCost();
+    return elapsed;
+}
+
+/**
+ * Strategies that take a job. <br>
+ * Worked out by Mom as she posts it, so a worker process filters on a bit of <br>
+ * the slot instead of on a Job object it does not have. <br>
+ * @param job Job being posted
+ * @return Bit s set if StrategyRegistry strategy s would take the job
+ */
+static uint64_t eligibleStrategies(const Job& job) {
+    uint64_t mask = 0;
+    for (int s = 0; s < StrategyRegistry::count(); s++) {
+        if (StrategyRegistry::get(s).eligible(job)) mask |= uint64_t(1) << s;
+    }
+    return mask;
+}
+
+/**
+ * Process run. <br>
+ * --------------------------------------------------
+ * - Creates the shared-memory table and posts the jobs of the JobTable to it
+ * - Forks a worker process per kid; each maps the segment again by name, at an
+ *   address of its own, and runs Kid::runProcess
+ * - Runs for Config::duration seconds like supervise(), refilling as soon as a worker completes a job
+ * - Reaps workers that die, puts their claimed jobs back and carries on without them
+ * - Ends early once every --input job is done
+ * - Stops the workers after their current job, waits for them and takes their counters
+ * @return Seconds the kids worked for, exact when the run ended early as in supervise()
+ */
+double Mom::superviseProcesses() {
+    if (StrategyRegistry::count() > 64) fatal("--processes supports at most 64 registered strategies");
+    ShmTable shared;
+    string segment = "/dispatcher-" + to_string(getpid());
+    if (!shared.create(segment, config.tableSize, config.kids, config.tick)) fatal("Cannot create shared memory segment " + segment);
+    for (int i = 0; i < config.tableSize; i++) {
+        Job* job = table.at(i);
+        if (job == nullptr) continue;
+        uint8_t jobRatings[3] = {static_cast<uint8_t>(job->slow), static_cast<uint8_t>(job->dirty), static_cast<uint8_t>(job->heavy)};
+        shared.fill(i, jobRatings, eligibleStrategies(*job));
+    }
+    shared.publish();
+
+    // Children leave through _exit, so nothing Mom buffered is written twice
+    cout << flush;
+    workers.assign(config.kids, 0);
+    for (int i = 0; i < config.kids; i++) {
+        pid_t pid = fork();
+        if (pid < 0) fatal("Cannot fork a worker process for " + Kid::makeName(i));
+        if (pid == 0) {
+            ShmTable own;
+            if (!own.attach(segment)) _exit(1);
+            kids[i].runProcess(own);
+            own.close();
+            _exit(0);
+        }
+        workers[i] = pid;
+    }
+    clock_gettime(CLOCK_REALTIME, &startTime);
+    ss << config.kids << " worker processes share " << segment << " (" << (shared.size() + 1023) / 1024 << " KiB)" << endl;
     Printer::write(ss, cout);
+    if (!EventLog::enabled() && !table.quiet) {
+        for (int i = 0; i < config.kids; i++) {
+            ss << "Start working: " << Kid::makeName(i) << ", mood is: " << StrategyRegistry::get(kids[i].getStrategy()).name
+               << ", process " << workers[i] << endl;
+            Printer::write(ss, cout);
+        }
+    }
+
+    // Wakes on each completion, when a leaderboard line or an export is due,
+    // and at least once a second to reap workers that died
+    long nextBoard = config.leaderboardEvery;
+    bool exporting = Metrics::enabled();
+    long nextExport = 1;
+    double now = 0;
+    while ((now = secondsRunning()) < config.duration) {
+        long wakeAt = min<long>(config.duration, static_cast<long>(now) + 1);
+        if (config.leaderboardEvery > 0) wakeAt = min(wakeAt, nextBoard);
+        if (exporting) wakeAt = min(wakeAt, nextExport);
+        timespec deadline{startTime.tv_sec + wakeAt, startTime.tv_nsec};
+        while (sem_timedwait(&shared.header().done, &deadline) != 0 && errno == EINTR) {}
+        while (sem_trywait(&shared.header().done) == 0) {}
+        scanSharedTable(shared);
+        reapWorkers(shared, false);
+        now = secondsRunning();
+        if (config.leaderboardEvery > 0 && now >= nextBoard) {
+            printLeaderboard(nextBoard);
+            nextBoard += config.leaderboardEvery;
+        }
+        if (exporting && now >= nextExport) {
+            Metrics::exportFiles();
+            nextExport = static_cast<long>(now) + 1;
+        }
+        if (emptySlots == config.tableSize) {
+            ss << "Every input job is done after " << fixed << setprecision(2) << now << " s" << defaultfloat << setprecision(6) << endl;
+            Printer::write(ss, cout);
+            break;
+        }
+    }
+    double elapsed = emptySlots == config.tableSize ? secondsRunning() : floor(secondsRunning());
 
-    // Create Kid threads
-    for (int i = 0; i < NUM_THREADS; i++) {
-        kids[i] = Kid(kidNames[i], &table);
+    shared.stop();
+    reapWorkers(shared, true);
+    scanSharedTable(shared);
+    for (int i = 0; i < config.kids; i++) kids[i].collect(shared.kid(i));
+    if (workersLost > 0) {
+        ss << workersLost << " of " << config.kids << " worker processes died; " << jobsReclaimed
+           << " jobs they had claimed went back on the table" << endl;
+        Printer::write(ss, cout);
+    }
+    shared.close();
+    return elapsed;
+}
+
+/**
+ * Collects completions from the shared-memory table. <br>
+ * Like scanJobTable, with the completed slots taken from the segment's done ring. <br>
+ * Mom finishes each job on its worker's behalf: she marks it complete, credits <br>
+ * the kid on the Leaderboard and counts it in her own metrics, since a worker's <br>
+ * buffers stay in its process. The slot then gets a new job, in the JobTable and <br>
+ * in the segment, or is left empty once the --input jobs run out. <br>
+ * @param shared The shared-memory table
+ */
+void Mom::scanSharedTable(ShmTable& shared) {
+    METRICS_SCOPE(Metric::REFILL);
+    sharedDone.clear();
+    shared.drain(sharedDone);
+    if (sharedDone.empty()) return;
+    size_t fresh = nextRatings(sharedDone.size());
+    for (size_t k = 0; k < sharedDone.size(); k++) {
+        int i = sharedDone[k];
+        ShmSlot& slot = shared.slot(i);
+        Job* done = table.at(i);
+        done->chooseJob(slot.kid, i);
+        done->status = JobStatus::COMPLETE;
+        table.scores.credit(slot.kid, done->value);
+        METRICS_JOB_DONE();
+        if (EventLog::enabled()) EventLog::record(EventType::JOB_DONE, slot.kid, i, done);
+        recordCompletion(done->summary());
+        JobHandle doneHandle = table.jobs[i];
+        if (k >= fresh) {
+            table.jobs[i] = JobHandle{};
+            table.pool.release(doneHandle);
+            slot.state.store(static_cast<uint32_t>(SlotState::EMPTY), memory_order_relaxed);
+            emptySlots++;
+            continue;
+        }
+        table.jobs[i] = table.pool.acquireOn(0, ratings[3 * k], ratings[3 * k + 1], ratings[3 * k + 2]);
+        table.pool.release(doneHandle);
+        prepareJob(i);
+        shared.fill(i, &ratings[3 * k], eligibleStrategies(*table.at(i)));
+    }
+    if (fresh > 0) shared.publish();
+
+    for (int i : sharedDone) {
+        if (!table.jobs[i].valid()) continue;
+        if (EventLog::enabled()) {
+            EventLog::record(EventType::JOB_REFILLED, EventLog::momId, i, table.at(i));
+            continue;
+        }
+        if (table.quiet) continue;
+        ss << "Adding new job at index: " << i << endl;
+        Printer::write(ss, cout);
+    }
+}
+
+/**
+ * Reaps worker processes. <br>
+ * A worker that exits with anything but status 0 died: it is reported, and the <br>
+ * jobs it had claimed are made claimable again for the workers still running. <br>
+ * @param shared The shared-memory table
+ * @param block Wait until every worker has exited, rather than only reap those that already have
+ */
+void Mom::reapWorkers(ShmTable& shared, bool block) {
+    for (int i = 0; i < config.kids; i++) {
+        if (workers[i] == 0) continue;
+        int status = 0;
+        pid_t reaped;
+        while ((reaped = waitpid(workers[i], &status, block ? 0 : WNOHANG)) < 0 && errno == EINTR) {}
+        if (reaped == 0) continue;
+        workers[i] = 0;
+        if (reaped < 0 || (WIFEXITED(status) && WEXITSTATUS(status) == 0)) continue;
+        workersLost++;
+        int returned = shared.reclaim(i);
+        jobsReclaimed += returned;
+        ss << "Worker " << Kid::makeName(i) << " (process " << reaped << ") ";
+        if (WIFSIGNALED(status)) ss << "was killed by signal " << WTERMSIG(status);
+        else ss << "exited with status " << WEXITSTATUS(status);
+        ss << "; " << returned << " claimed jobs went back on the table" << endl;
+        Printer::write(ss, cout);
+    }
+}
+
+/**
+ * Signal start. <br>
+ * Creates a pthread per kid, then sends each one SIGUSR1 in turn.
+ */
+void Mom::startWithSignals() {
+    for (int i = 0; i < config.kids; i++) {
         int rc = pthread_create(&kidThreadTids[i], nullptr, kidMain, &kids[i]);
-        ss << "Kid created: " << kidNames[i] << endl;
+        ss << "Kid created: " << Kid::makeName(i) << endl;
         Printer::write(ss, cout);
         if (rc) cerr << "ERROR; failed to create kid thread";
+        else pinKid(i, kidThreadTids[i]);
     }
 
+    table.quitFlag = true;
+    startCommand = chrono::steady_clock::now();
+
     // Signal each kid to start
-    for (int i = 0; i < NUM_THREADS; i++) {
+    for (int i = 0; i < config.kids; i++) {
         pthread_kill(kidThreadTids[i], SIGUSR1);
-        ss << "Signal sent to start work: " << kidNames[i] << endl;
+        ss << "Signal sent to start work: " << Kid::makeName(i) << endl;
         Printer::write(ss, cout);
     }
+}
+
+/**
+ * Latch start. <br>
+ * Creates a jthread per kid and waits until every kid is parked on the start latch, <br>
+ * then opens it so they are all released together.
+ * @param ready Counted down by each kid once it waits on start
+ * @param start Opened once, by Mom
+ */
+void Mom::startWithLatch(latch& ready, latch& start) {
+    kidThreads.reserve(config.kids);
+    for (int i = 0; i < config.kids; i++) {
+        kidThreads.emplace_back([this, i, &ready, &start](stop_token token) { kids[i].run(token, ready, start); });
+        pinKid(i, kidThreads[i].native_handle());
+        ss << "Kid created: " << Kid::makeName(i) << endl;
+        Printer::write(ss, cout);
+    }
+    ready.wait();
 
     table.quitFlag = true;
-    time(&startTime);
+    startCommand = chrono::steady_clock::now();
+    start.count_down();
+    ss << "Start latch opened for " << config.kids << " kids" << endl;
+    Printer::write(ss, cout);
+}
 
-    // Run simulation for 21 seconds
-    while (difftime(time(&currentTime), startTime) < 21) {
-        sleep(1);
-        scanJobTable();
-    }
+/**
+ * Coroutine start. <br>
+ * Spawns one coroutine per kid, suspended at its start, then starts the <br>
+ * worker threads, which is the start command. Parked kids are handed to <br>
+ * the scheduler by the table when a job lands in their bucket.
+ */
+void Mom::startWithScheduler() {
+    scheduler = make_unique<KidScheduler>();
+    table.scheduler = scheduler.get();
+    table.quitFlag = true;
+    for (Kid& kid : kids) scheduler->spawn(kid.coRun(*scheduler));
+    residentWithKids = residentBytes();
+
+    startCommand = chrono::steady_clock::now();
+    scheduler->start(config.pool);
+    ss << config.kids << " coroutine kids started on " << config.pool << " threads" << endl;
+    Printer::write(ss, cout);
+}
+
+/**
+ * Coroutine stop. <br>
+ * Clears quitFlag and hands every parked kid back to the scheduler; kids <br>
+ * sleeping on a job finish it, as under token control. Returns once every <br>
+ * kid has returned and the workers are joined.
+ */
+void Mom::stopWithScheduler() {
+    table.quitFlag = false;
+    table.wakeAll();
+    scheduler->join();
+    table.scheduler = nullptr;
+
+    for (Kid& kid : kids) kid.printCompletedJob();
+}
+
+/**
+ * Prints the cost of coroutine kids. <br>
+ * Frame bytes are counted by the coroutine's allocator; the resident figure is <br>
+ * the growth from before the kids were built to after they were all spawned, <br>
+ * so it also covers Kid objects, their queues and the leaderboard rows.
+ */
+void Mom::reportCoroutineCost() {
+    double frame = double(KidCoroutine::promise_type::frameBytes.load()) / max<size_t>(KidCoroutine::promise_type::frames.load(), 1);
+    double resident = residentWithKids > residentBeforeKids ? double(residentWithKids - residentBeforeKids) : 0;
+    ss << fixed << setprecision(1) << "Coroutine kids: " << config.kids << " on " << config.pool << " threads, "
+       << frame << " B frame + " << sizeof(Kid) << " B Kid each; resident memory +" << resident / (1 << 20) << " MB ("
+       << resident / config.kids << " B per kid)" << endl;
+    Printer::write(ss, cout);
+    ss << "Scheduler: " << scheduler->resumes() << " resumes, " << scheduler->overheadPerResume()
+       << " ns scheduler overhead per resume" << defaultfloat << setprecision(6) << endl;
+    Printer::write(ss, cout);
+}
+
+/**
+ * Signal stop. <br>
+ * Clears quitFlag, wakes parked kids and sends each kid SIGQUIT, <br>
+ * which ends a kid in the middle of its job, then joins them.
+ */
+void Mom::stopWithSignals() {
+    table.quitFlag = false;
+    table.wakeAll();
 
     // Signal each kid to stop and print their results
-    for (int i = 0; i < NUM_THREADS; i++) {
+    for (int i = 0; i < config.kids; i++) {
         pthread_kill(kidThreadTids[i], SIGQUIT);
         ss << "------------------Kids--------------------------------" << endl;
         Printer::write(ss, cout);
         kids[i].printCompletedJob();
-        ss << "Signal sent to stop work: " << kidNames[i] << endl;
+        ss << "Signal sent to stop work: " << Kid::makeName(i) << endl;
         Printer::write(ss, cout);
         ss << "------------------Kids- End--------------------------------" << endl;
         Printer::write(ss, cout);
     }
 
     // Join threads
-    for (int i = 0; i < NUM_THREADS; i++) {
+    for (int i = 0; i < config.kids; i++) {
         void* retVal;
         pthread_join(kidThreadTids[i], &retVal);
-        ss << "Kid " << kidNames[i] << " joined" << endl;
+        ss << "Kid " << Kid::makeName(i) << " joined" << endl;
         Printer::write(ss, cout);
     }
+}
 
+/**
+ * Token stop. <br>
+ * Requests a stop on every kid's jthread and wakes the parked ones. <br>
+ * A working kid finishes and announces its current job before it leaves, <br>
+ * so results are printed only after every kid has been joined.
+ */
+void Mom::stopWithTokens() {
+    for (jthread& thread : kidThreads) thread.request_stop();
+    table.wakeAll();
+
+    for (int i = 0; i < config.kids; i++) {
+        kidThreads[i].join();
+        ss << "Kid " << Kid::makeName(i) << " joined" << endl;
+        Printer::write(ss, cout);
+    }
     table.quitFlag = false;
-    scanJobTable();
 
-    // Tally results
-    unordered_map<string, int> totalEarnings;
-    for (Job* job : completedJobs) {
-        totalEarnings[job->kidName] += job->value;
+    for (int i = 0; i < config.kids; i++) {
+        ss << "------------------Kids--------------------------------" << endl;
+        Printer::write(ss, cout);
+        kids[i].printCompletedJob();
+        ss << "------------------Kids- End--------------------------------" << endl;
+        Printer::write(ss, cout);
+    }
+}
+
+/**
+ * Prints start latency. <br>
+ * Times are measured from the start command: the first SIGUSR1 or the latch opening. <br>
+ * Kids that never claimed a job are left out of the first-claim figures.
+ */
+void Mom::reportStartLatency() {
+    auto micros = [this](chrono::steady_clock::time_point t) {
+        return chrono::duration<double, micro>(t - startCommand).count();
+    };
+    vector<double> releases, claims;
+    for (Kid& kid : kids) {
+        releases.push_back(micros(kid.releaseTime()));
+        if (kid.firstClaimTime() != chrono::steady_clock::time_point{}) claims.push_back(micros(kid.firstClaimTime()));
     }
+    sort(releases.begin(), releases.end());
+    sort(claims.begin(), claims.end());
+    ss << fixed << setprecision(1) << (config.pool > 0 ? string("COROUTINE") : controlModeName[static_cast<int>(config.control)])
+       << " control: kids released " << releases.front() << "-" << releases.back() << " us after the start command";
+    if (!claims.empty()) {
+        ss << ", first claims " << claims.front() << " / " << claims[claims.size() / 2] << " / " << claims.back()
+           << " us (min / median / max)";
+    }
+    ss << defaultfloat << setprecision(6) << endl;
+    Printer::write(ss, cout);
+}
+
+/**
+ * Virtual-clock run. <br>
+ * --------------------------------------------------
+ * - Replays the real-time rules on the calling thread, with no sleeping:
+ *   a kid that starts a job at time t is due back at t + slow.
+ * - Due kids are popped from a min-heap keyed by (time, kid index).
+ * - At each due time the finishing kids announce their jobs and try to start
+ *   the next one in kid order, as a kid does before Mom wakes up; then Mom
+ *   refills the table and every idle kid tries again.
+ * - Live leaderboard lines show the board as of their simulated time.
+ * - A job's task, if it has one, runs when the job is due; only its
+ *   slow rating moves the clock.
+ * - Jobs still running at Config::duration are left unfinished, as a
+ *   stopped kid's job is in a real-time run.
+ * - Everything is deterministic for a given seed.
+ * - All timings land in Mom's metrics, as every kid runs on Mom's thread.
+ * @return Simulated seconds: Config::duration, or when the last --input job was done
+ */
+double Mom::simulate() {
+    struct Due {
+        long time;
+        int kid;
+        bool operator>(const Due& other) const { return tie(time, kid) > tie(other.time, other.kid); }
+    };
+    priority_queue<Due, vector<Due>, greater<>> pending;
+    vector<int> idle;
+    long now = 0;
+    auto wallStart = chrono::steady_clock::now();
+
+    auto tryStart = [&](int k) {
+        if (!kids[k].startNextJob()) return false;
+        pending.push({now + kids[k].currentJob()->slow, k});
+        return true;
+    };
 
-    string winner;
-    int maxEarnings = -1;
-    for (auto& [name, value] : totalEarnings) {
-        if (value > maxEarnings) {
-            maxEarnings = value;
-            winner = name;
+    table.quiet = true;
+    table.quitFlag = true;
+    for (int k = 0; k < config.kids; k++) {
+        if (!tryStart(k)) idle.push_back(k);
+    }
+    long nextBoard = config.leaderboardEvery;
+    long nextSnapshot = config.snapshotEvery;
+    while (!pending.empty() && pending.top().time < config.duration) {
+        while (config.leaderboardEvery > 0 && nextBoard < pending.top().time) {
+            printLeaderboard(nextBoard);
+            nextBoard += config.leaderboardEvery;
+        }
+        now = pending.top().time;
+        table.simulatedNow = now;
+        while (!pending.empty() && pending.top().time == now) {
+            int k = pending.top().kid;
+            pending.pop();
+            if (kids[k].currentJob()->hasTask()) kids[k].currentJob()->runTask();
+            kids[k].finishJob();
+            if (!tryStart(k)) idle.push_back(k);
+        }
+        scanJobTable();
+        if (ledger && config.snapshotEvery > 0 && now >= nextSnapshot) {
+            takeSnapshot();
+            nextSnapshot = (now / config.snapshotEvery + 1) * config.snapshotEvery;
         }
+        sort(idle.begin(), idle.end());
+        erase_if(idle, [&](int k) { return tryStart(k); });
+    }
+    table.quitFlag = false;
+    for (Kid& kid : kids) kid.returnReserved();
+
+    double wall = chrono::duration<double>(chrono::steady_clock::now() - wallStart).count();
+    double simulated = emptySlots == config.tableSize ? static_cast<double>(now) : config.duration;
+    ss << "Simulated " << simulated << " s in " << wall << " s of wall time" << endl;
+    Printer::write(ss, cout);
+    return simulated;
+}
+
+/**
+ * Prepares a freshly acquired job. <br>
+ * With --work the job gets a task that mixes a 64-bit value for slow x work rounds <br>
+ * and returns it, so a kid spends time in proportion to the job's rating. <br>
+ * The capture is 16 bytes and stays in the task's inline buffer. <br>
+ * With --deps the job waits for that many jobs drawn from Mom's stream among the <br>
+ * last tableSize claimable jobs she created, jobs some kid's strategy takes; any of <br>
+ * them may already be done, and the same one may be drawn twice. A drawn job whose <br>
+ * handle has gone stale was done and released, so it is skipped. Every predecessor <br>
+ * is older and claimable, so the oldest unfinished claimable job is always ready; <br>
+ * only jobs no kid would take anyway can be left blocked. <br>
+ * @param slot Slot holding the job
+ * @return true if the job can be posted now
+ */
+bool Mom::prepareJob(int slot) {
+    Job* job = table.at(slot);
+    job->postedAt = table.now();
+    job->jobNumber = slot;
+    if (config.work >= 0) {
+        uint64_t start = uint64_t(table.jobs[slot].index) << 32 | table.jobs[slot].generation;
+        long rounds = job->slow * config.work;
+        job->setTask([start, rounds]() {
+            uint64_t h = start;
+            for (long r = 0; r < rounds; r++) h = (h ^ (h >> 31)) * 0x9E3779B97F4A7C15ull + r;
+            return static_cast<int64_t>(h);
+        });
+    }
+    if (config.deps == 0) return true;
+
+    predecessors.clear();
+    long candidates = min<long>(claimableCreated, config.tableSize);
+    for (int d = 0; d < config.deps && candidates > 0; d++) {
+        Job* predecessor = table.pool.get(recentJobs[Rng::local().between(0, static_cast<int>(candidates) - 1)]);
+        if (predecessor != nullptr) predecessors.push_back(predecessor);
     }
-    totalEarnings[winner] += 5;
+    jobsCreated++;
+    if (table.claimable(*job)) recentJobs[claimableCreated++ % config.tableSize] = table.jobs[slot];
+    dependencyEdges += static_cast<long>(predecessors.size());
+    bool ready = job->waitFor(predecessors);
+    if (!ready) blockedJobs++;
+    return ready;
+}
+
+/**
+ * Main control logic for the Mom thread. <br>
+ * --------------------------------------------------
+ * - Prints welcome message
+ * - Rolls each kid's mood, or deals the --moods list, so jobs can be routed in STEAL mode
+ * - Initializes jobs
+ * - Runs the kids in real time or on the virtual clock
+ * - Prints summary results
+ */
+void Mom::run() {
+    Rng::local() = Rng(config.seed, 0);
+    Metrics::attach("mom");
+    Tracer::attach();
+    Tracer::nameTrack(Tracer::momTrack, "Mom");
+    print();
+    ss << "Seed: " << config.seed << endl;
+    Printer::write(ss, cout);
+    ss << "Scheduling mode: " << schedModeName[static_cast<int>(config.schedule)];
+    if (config.schedule == SchedMode::SCAN) ss << " (" << JobColumns::kernelName() << " kernel)";
+    if (config.clock == ClockMode::VIRTUAL) ss << ", virtual clock";
+    if (config.processes) ss << ", worker processes on a shared-memory table";
+    ss << endl;
+    Printer::write(ss, cout);
+    if (table.shards.size() > 1) {
+        ss << "JobTable split into " << table.shards.size() << " shards on NUMA nodes";
+        for (const unique_ptr<JobTable::Shard>& shard : table.shards) ss << " " << shard->node;
+        ss << endl;
+        Printer::write(ss, cout);
+    }
+    if (!config.pinCpus.empty()) {
+        ss << "Kid threads pinned in turn to CPUs";
+        for (int cpu : config.pinCpus) ss << " " << cpu;
+        ss << endl;
+        Printer::write(ss, cout);
+    }
+
+    // Job wait times count from here
+    table.startedAt = chrono::steady_clock::now();
+
+    // Kids pick their moods before any job is posted
+    residentBeforeKids = residentBytes();
+    kids.reserve(config.kids);
+    for (int i = 0; i < config.kids; i++) {
+        kids.emplace_back(Kid::makeName(i), i, &table);
+        kids[i].selectMood(config.seed, config.moods.empty() ? -1 : config.moods[i % config.moods.size()]);
+        if (config.schedule == SchedMode::STEAL) table.addQueue(kids[i].getStrategy());
+        table.addClaimer(kids[i].getStrategy());
+        kids[i].setShard(homeShard(i, config.pinCpus.empty() ? -1 : config.pinCpus[i % config.pinCpus.size()]));
+    }
+    kidThreadTids.resize(config.kids);
+
+    if (ledger) {
+        ledger->restore(config.tableSize, config.kids, ledgerState);
+        if (ledgerState.restored) {
+            ss << "Restored the table and " << ledgerState.records << " completions worth " << ledgerState.value << " from "
+               << config.ledgerDir << endl;
+            Printer::write(ss, cout);
+        }
+    }
+    initializeJobTable();
+    ss << "Job Table Initialized" << endl;
+    Printer::write(ss, cout);
+    if (ledger) takeSnapshot();
+
+    double elapsed = config.clock == ClockMode::VIRTUAL ? simulate() : config.processes ? superviseProcesses() : supervise();
+
+    scanJobTable();
+    Metrics::exportFiles();
+    if (ledger) {
+        takeSnapshot();
+        ledger->close();
+    }
+    if (source) source->close();
+
+    // Every kid has been joined, so the leaderboard is final
+    vector<Leaderboard::Entry> standings = table.scores.snapshot();
+    Leaderboard::Entry winner = table.scores.leader();
+    const int winnerBonus = 5;  // the winner's total includes it wherever it is printed
 
     ss << "--------------------Mama-----------------------------" << endl;
     Printer::write(ss, cout);
 
-    for (Job* job : completedJobs) {
-        ss << "Child " << job->kidName << " has earned a total value of " << job->value << " on this job " << job->jobNumber << endl;
+    if (table.quiet && config.kids > 100) {
+        // Too many kids for a line each: sum them per mood
+        vector<long> kidsPerMood(StrategyRegistry::count()), jobsPerMood(StrategyRegistry::count()), valuePerMood(StrategyRegistry::count());
+        for (const Leaderboard::Entry& entry : standings) {
+            int mood = kids[entry.kidId].getStrategy();
+            kidsPerMood[mood]++;
+            jobsPerMood[mood] += entry.jobs;
+            valuePerMood[mood] += entry.value + (entry.kidId == winner.kidId ? winnerBonus : 0);
+        }
+        for (size_t mood = 0; mood < kidsPerMood.size(); mood++) {
+            if (kidsPerMood[mood] == 0) continue;
+            ss << kidsPerMood[mood] << " " << StrategyRegistry::get(mood).name << " kids completed " << jobsPerMood[mood]
+               << " jobs for a total value of " << valuePerMood[mood] << endl;
+            Printer::write(ss, cout);
+        }
+    } else if (table.quiet) {
+        for (const Leaderboard::Entry& entry : standings) {
+            ss << "Child " << Kid::makeName(entry.kidId) << " (" << StrategyRegistry::get(kids[entry.kidId].getStrategy()).name
+               << ") completed " << entry.jobs << " jobs for a total value of "
+               << entry.value + (entry.kidId == winner.kidId ? winnerBonus : 0) << endl;
+            Printer::write(ss, cout);
+        }
+    } else {
+        for (const CompletedJob& job : completedJobs) {
+            ss << "Child " << Kid::makeName(job.kidId) << " has earned a total value of " << job.value << " on this job " << job.jobNumber << endl;
+            Printer::write(ss, cout);
+        }
+    }
+    ss << "The winner for today is " << Kid::makeName(winner.kidId) << ", who had a total of " << winner.value + winnerBonus << endl;
+    Printer::write(ss, cout);
+
+    long claims = 0;
+    long tableLocks = 0;
+    for (Kid& kid : kids) {
+        claims += kid.claimCount();
+        tableLocks += kid.tableLockCount();
+    }
+    ss << schedModeName[static_cast<int>(config.schedule)] << (config.processes ? " PROCESS" : "") << " mode: " << claims
+       << " claims in " << elapsed << " s (" << perSecond(claims, elapsed) << " claims/sec)" << endl;
+    Printer::write(ss, cout);
+    if (!config.processes) {
+        ss << "Kid table locks: " << tableLocks << " (" << tableLocks / max<double>(jobsCompleted, 1.0)
+           << " per completed job, batch " << config.batch << ")" << endl;
+        Printer::write(ss, cout);
+    }
+    printValueAndWait(standings, elapsed);
+    if (table.shards.size() > 1) printShardClaims();
+
+    if (config.work >= 0) {
+        ss << "Task results: " << taskResults << " (checksum " << hex << resultChecksum << dec << ")" << endl;
+        Printer::write(ss, cout);
+    }
+    if (source) {
+        source->print(ss);
+        ss << endl;
+        Printer::write(ss, cout);
+    }
+    if (ledger) {
+        ledger->print(ss);
+        ss << endl;
         Printer::write(ss, cout);
+        ss << fixed << setprecision(2) << "Durable completions: " << jobsCompleted << " ("
+           << perSecond(jobsCompleted, elapsed) << " per second); the ledger holds " << ledgerState.records
+           << " completions worth " << ledgerState.value << " over every run" << defaultfloat << setprecision(6) << endl;
+        Printer::write(ss, cout);
+    }
+    if (config.deps > 0) {
+        long waiting = 0;
+        for (int i = 0; i < config.tableSize; i++) waiting += table.at(i) != nullptr && !table.at(i)->isReady();
+        ss << "Dependencies: " << dependencyEdges << " edges over " << jobsCreated << " jobs, " << blockedJobs
+           << " created blocked, " << waiting << " still blocked at the end" << endl;
+        Printer::write(ss, cout);
+    }
+}
+
+/**
+ * Prints value throughput and job wait times. <br>
+ * Waits run from Mom posting a job to a kid claiming it. Jobs still on the table <br>
+ * are counted as waiting until now, since a job no kid ever takes never reports a wait. <br>
+ * @param standings Final leaderboard
+ * @param elapsed Seconds the run lasted, real or simulated
+ */
+void Mom::printValueAndWait(const vector<Leaderboard::Entry>& standings, double elapsed) {
+    long value = 0;
+    for (const Leaderboard::Entry& entry : standings) value += entry.value;
+    double totalWait = 0;
+    double maxWait = 0;
+    long claims = 0;
+    for (Kid& kid : kids) {
+        totalWait += kid.totalWaitTime();
+        maxWait = max(maxWait, kid.maxWaitTime());
+        claims += kid.claimCount();
     }
+    double now = table.now();
+    double oldest = 0;
+    for (int i = 0; i < static_cast<int>(table.jobs.size()); i++) {
+        Job* job = table.at(i);
+        if (job != nullptr && job->status == JobStatus::NOT_STARTED) oldest = max(oldest, now - job->postedAt);
+    }
+    ss << fixed << setprecision(2) << "Value: " << value << " (" << perSecond(value, elapsed) << " per second); job wait: mean "
+       << totalWait / max<long>(claims, 1) << " s, max " << maxWait << " s, oldest unclaimed " << oldest << " s" << endl;
+    Printer::write(ss, cout);
+    ss << defaultfloat << setprecision(6);
+}
 
-    ss << "The winner for today is " << winner << ", who had a total of " << totalEarnings[winner] << endl;
+/**
+ * Prints shard locality. <br>
+ * A claim is remote when a kid took it from a shard other than its home one, <br>
+ * which only happens once its home shard had nothing for it. <br>
+ */
+void Mom::printShardClaims() {
+    vector<long> local(table.shards.size()), remote(table.shards.size());
+    for (Kid& kid : kids) {
+        local[kid.getShard()] += kid.claimCount() - kid.remoteClaimCount();
+        remote[kid.getShard()] += kid.remoteClaimCount();
+    }
+    long localTotal = 0, remoteTotal = 0;
+    for (size_t s = 0; s < table.shards.size(); s++) {
+        localTotal += local[s];
+        remoteTotal += remote[s];
+        ss << "Shard " << s << " (node " << table.shards[s]->node << "): its kids made " << local[s] << " local and "
+           << remote[s] << " remote claims" << endl;
+        Printer::write(ss, cout);
+    }
+    ss << fixed << setprecision(1) << "Shard claims: " << localTotal << " local, " << remoteTotal << " remote ("
+       << 100.0 * remoteTotal / max(localTotal + remoteTotal, 1L) << "% remote)" << defaultfloat << setprecision(6) << endl;
     Printer::write(ss, cout);
 }
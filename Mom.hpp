@@ -2,32 +2,118 @@
 #include "tools.hpp"
 #include "JobTable.hpp"
 #include "Kid.hpp"
-#define NUM_THREADS 4
+#include "Config.hpp"
+#include "KidScheduler.hpp"
+#include "Ledger.hpp"
+#include "JobSource.hpp"
+#include "ShmTable.hpp"
+#include <chrono>
+#include <latch>
+#include <thread>
 
 /**
  * Mom Class <br>
  * --------------------------------------------------------------<br>
  * - Manages the job table and interacts with child threads (Kids). <br>
- * - Spawns a fixed number of threads (4 kids) for chore execution. <br>
+ * - Spawns one thread per kid, as many as Config asks for, or one worker process per kid with --processes. <br>
  * - Tracks completed jobs and manages the lifecycle of the simulation. <br>
  * --------------------------------------------------------------<br>
  */
 class Mom {
 private:
+    Config config;                          ///< Startup options for this run <br>
     JobTable table;                         ///< Shared job table <br>
-    const string kidNames[4] = {"Ali", "Cory", "Lee", "Pat"}; ///< Array of kid names <br>
-    Kid kids[NUM_THREADS];                  ///< Array of Kid objects <br>
-    pthread_t kidThreadTids[NUM_THREADS];   ///< Thread IDs for each Kid <br>
-    vector<Job*> completedJobs;             ///< Stores completed jobs <br>
-    time_t startTime;                       ///< Start time of the chore session <br>
+    vector<Kid> kids;                       ///< Kid objects, one per worker thread <br>
+    vector<pthread_t> kidThreadTids;        ///< Thread IDs for each Kid under signal control <br>
+    vector<jthread> kidThreads;             ///< Kid threads under token control <br>
+    unique_ptr<KidScheduler> scheduler;     ///< Worker pool running the kids as coroutines, with --pool <br>
+    size_t residentBeforeKids = 0;          ///< Resident bytes before the kids were built <br>
+    size_t residentWithKids = 0;            ///< Resident bytes once every coroutine kid was spawned <br>
+    chrono::steady_clock::time_point startCommand;  ///< When Mom told the kids to start <br>
+    vector<uint8_t> ratings;                ///< Scratch ratings for the jobs being posted <br>
+    unique_ptr<JobSource> source;           ///< Recorded jobs streamed from --input <br>
+    int emptySlots = 0;                     ///< Slots left empty once the input ran out <br>
+    unique_ptr<Ledger> ledger;              ///< Completion ledger and table snapshots, with --ledger <br>
+    LedgerState ledgerState;                ///< Table and totals as of the last appended record <br>
+    vector<LedgerRecord> ledgerBatch;       ///< Scratch records for one scanJobTable pass <br>
+    vector<JobHandle> recentJobs;           ///< The last Config::tableSize claimable jobs created, candidates for predecessors <br>
+    vector<Job*> predecessors;              ///< Scratch predecessor list for the job being prepared <br>
+    long jobsCreated = 0;                   ///< Jobs created so far <br>
+    long claimableCreated = 0;              ///< Jobs created so far that some kid would take, also the next recentJobs position <br>
+    long dependencyEdges = 0;               ///< Predecessors declared over the run <br>
+    long blockedJobs = 0;                   ///< Jobs that were not ready when created <br>
+    vector<pid_t> workers;                  ///< Worker process per kid with --processes, 0 once reaped <br>
+    vector<int> sharedDone;                 ///< Scratch slot list for one scanSharedTable pass <br>
+    int workersLost = 0;                    ///< Worker processes that died before Mom stopped them <br>
+    long jobsReclaimed = 0;                 ///< Jobs put back on the table after their worker died <br>
+    vector<CompletedJob> completedJobs;     ///< Records of completed jobs for the per-job summary, kept unless quiet <br>
+    long jobsCompleted = 0;                 ///< Jobs collected, whose Jobs went back to table.pool <br>
+    long taskResults = 0;                   ///< Collected jobs whose task returned a result <br>
+    uint64_t resultChecksum = 0;            ///< XOR of those results <br>
+    timespec startTime{};                   ///< Start time of the chore session, on CLOCK_REALTIME <br>
     time_t currentTime;                     ///< Current time for duration tracking <br>
 
+    /**
+     * Collects the jobs worker processes completed and refills their slots. <br>
+     * @param shared The shared-memory table <br>
+     */
+    void scanSharedTable(ShmTable& shared);
+
+    /**
+     * Reaps worker processes that exited and puts their claimed jobs back. <br>
+     * @param shared The shared-memory table <br>
+     * @param block Waits for every worker, once they have been told to stop <br>
+     */
+    void reapWorkers(ShmTable& shared, bool block);
+
+    /**
+     * Fills ratings for a batch of new jobs from Mom's random stream. <br>
+     * @param count Number of jobs <br>
+     */
+    void rollRatings(size_t count);
+
+    /**
+     * Fills ratings for the next jobs: from the input when there is one, rolled otherwise. <br>
+     * @param count Number of jobs wanted <br>
+     * @return Jobs whose ratings were filled; fewer than count once the input is used up <br>
+     */
+    size_t nextRatings(size_t count);
+
+    /**
+     * Syncs the ledger and snapshots ledgerState to it. <br>
+     */
+    void takeSnapshot();
+
+    /**
+     * Picks a kid's home shard: one on the NUMA node of its CPU when it is pinned. <br>
+     * @param kid Kid index <br>
+     * @param cpu CPU the kid will be pinned to, -1 if unpinned <br>
+     * @return Shard index <br>
+     */
+    int homeShard(int kid, int cpu) const;
+
+    /**
+     * Pins a kid's thread to its CPU from Config::pinCpus, if any. <br>
+     * @param kid Kid index <br>
+     * @param thread The kid's thread <br>
+     */
+    void pinKid(int kid, pthread_t thread);
+
+    /**
+     * Gives a new job its task when Config::work asks for tasks, its predecessors <br>
+     * when Config::deps asks for them, and stamps its post time. <br>
+     * @param slot Slot the job was just put in <br>
+     * @return true if the job is ready to post, false if it waits for a predecessor <br>
+     */
+    bool prepareJob(int slot);
+
 public:
     Mom() = default;
-    ~Mom(); ///< Destructor closes threads and handles cleanup <br>
+    explicit Mom(const Config& config);     ///< Builds a Mom for the given startup options <br>
+    ~Mom() = default; ///< Jobs still in the table are freed with table.pool <br>
 
     /**
-     * Initializes the JobTable with random jobs. <br>
+     * Initializes the JobTable with random jobs, or with the jobs restored from the ledger. <br>
      * Called before threads are started. <br>
      */
     void initializeJobTable();
@@ -38,6 +124,101 @@ public:
      */
     void scanJobTable();
 
+    /**
+     * Counts a collected job, before its Job goes back to the pool. <br>
+     * @param done The job's record <br>
+     */
+    void recordCompletion(const CompletedJob& done);
+
+    /**
+     * Blocks until a kid announces a completed job or the deadline passes. <br>
+     * @param deadline Absolute CLOCK_REALTIME time to give up at <br>
+     */
+    void waitForCompletions(const timespec& deadline);
+
+    /**
+     * Runs the kid threads in real time until Config::duration has passed. <br>
+     * @return Elapsed seconds <br>
+     */
+    double supervise();
+
+    /**
+     * Runs the kids as worker processes on a shared-memory table until Config::duration has passed. <br>
+     * @return Elapsed seconds <br>
+     */
+    double superviseProcesses();
+
+    /**
+     * Starts kid pthreads with SIGUSR1. <br>
+     */
+    void startWithSignals();
+
+    /**
+     * Starts kid jthreads and releases them together through a latch. <br>
+     * @param ready Latch each kid counts down once it is waiting <br>
+     * @param start Latch Mom opens to release the kids <br>
+     */
+    void startWithLatch(latch& ready, latch& start);
+
+    /**
+     * Spawns every kid as a coroutine and starts the worker pool. <br>
+     */
+    void startWithScheduler();
+
+    /**
+     * Lets coroutine kids finish their current job, then stops the pool. <br>
+     */
+    void stopWithScheduler();
+
+    /**
+     * Prints memory per coroutine kid and the scheduler's overhead per resume. <br>
+     */
+    void reportCoroutineCost();
+
+    /**
+     * Stops kid pthreads with SIGQUIT and joins them. <br>
+     */
+    void stopWithSignals();
+
+    /**
+     * Stops kid jthreads at a job boundary through their stop tokens and joins them. <br>
+     */
+    void stopWithTokens();
+
+    /**
+     * Prints the time from the start command to each kid's release and first claim. <br>
+     */
+    void reportStartLatency();
+
+    /**
+     * Runs the kids on a virtual clock, on the calling thread. <br>
+     * @return Simulated seconds <br>
+     */
+    double simulate();
+
+    /**
+     * Returns the seconds elapsed since startTime. <br>
+     */
+    double secondsRunning();
+
+    /**
+     * Prints a snapshot of the leaderboard. <br>
+     * @param at Seconds into the run <br>
+     */
+    void printLeaderboard(long at);
+
+    /**
+     * Prints total value per second and how long jobs waited to be claimed. <br>
+     * @param standings Final leaderboard <br>
+     * @param elapsed Seconds the run lasted <br>
+     */
+    void printValueAndWait(const vector<Leaderboard::Entry>& standings, double elapsed);
+
+    /**
+     * Prints how many claims kids took from their home shard and from the others. <br>
+     */
+    void printShardClaims();
+
     /**
      * Prints summary of jobs and performance stats to terminal and file. <br>
      */
@@ -46,8 +227,8 @@ public:
     /**
      * Main function that: <br>
      * - Initializes jobs <br>
-     * - Launches 4 Kid threads <br>
-     * - Runs for a fixed duration (e.g., 20 seconds) <br>
+     * - Launches Config::kids Kid threads <br>
+     * - Runs for Config::duration seconds <br>
      * - Terminates kids and summarizes job completion <br>
      */
     void run();
@@ -4,6 +4,12 @@
 #include "tools.hpp"
 #include "Printer.hpp"
 
+/** Stream tags stored with each queued record */
+enum : uint32_t { TO_COUT = 0, TO_CERR = 1 };
+
+/** Size of each thread's ring in bytes */
+static const size_t ringBytes = 1 << 16;
+
 /**
  * Static instance initialization for the singleton Printer.<br>
  * Ensures a single Printer object manages all output logging.<br>
@@ -14,13 +20,152 @@ Printer Printer::instance;
  * Constructor for the Printer class.<br>
  * -------------------------------------------------------<br>
  * - Opens the `output.txt` file in write mode.<br>
+ * - Initializes the locks for direct writes and ring registration.<br>
  * - Used to initialize the singleton Printer instance.<br>
  * -------------------------------------------------------<br>
  */
 Printer::Printer() {
+    pthread_mutex_init(&lock, nullptr);
+    pthread_mutex_init(&ringsLock, nullptr);
     instance.file.open("output.txt", ios::out);
 }
 
+/**
+ * Writes a message to the output stream and the log file right away.<br>
+ * -------------------------------------------------------<br>
+ * @param data Message bytes.<br>
+ * @param length Message size.<br>
+ * @param out Reference to the output stream (e.g., std::cout).<br>
+ * -------------------------------------------------------<br>
+ */
+void Printer::writeDirect(const char* data, size_t length, ostream& out) {
+    pthread_mutex_lock(&instance.lock);
+    out.write(data, static_cast<streamsize>(length));
+    instance.file.write(data, static_cast<streamsize>(length));
+    pthread_mutex_unlock(&instance.lock);
+}
+
+/**
+ * Returns the ring owned by the calling thread.<br>
+ * -------------------------------------------------------<br>
+ * - The first call on a thread allocates the ring and registers it
+ *   so the flusher can find it.<br>
+ * - Rings outlive their threads and are freed by stopAsync().<br>
+ * -------------------------------------------------------<br>
+ */
+SpscRing& Printer::threadRing() {
+    thread_local SpscRing* ring = nullptr;
+    if (ring == nullptr) {
+        pthread_mutex_lock(&instance.ringsLock);
+        instance.rings.push_back(make_unique<SpscRing>(ringBytes));
+        ring = instance.rings.back().get();
+        pthread_mutex_unlock(&instance.ringsLock);
+    }
+    return *ring;
+}
+
+/**
+ * Queues a message for the flusher thread.<br>
+ * -------------------------------------------------------<br>
+ * - Costs one memcpy into the calling thread's ring.<br>
+ * - Streams other than cout/cerr, and messages bigger than a ring,
+ *   are written directly instead.<br>
+ * - A full ring is waited on, never dropped.<br>
+ * -------------------------------------------------------<br>
+ */
+void Printer::enqueue(const char* data, size_t length, ostream& out) {
+    uint32_t tag;
+    if (&out == &cout) tag = TO_COUT;
+    else if (&out == &cerr) tag = TO_CERR;
+    else return writeDirect(data, length, out);
+
+    SpscRing& ring = threadRing();
+    if (length > ring.maxRecord()) return writeDirect(data, length, out);
+    while (!ring.push(tag, data, length)) sched_yield();
+}
+
+/**
+ * Drains every registered ring once.<br>
+ * -------------------------------------------------------<br>
+ * - Records are gathered into one batch per destination and written
+ *   with a single call each, so terminal and file I/O is amortized.<br>
+ * - Order is preserved per thread, not across threads.<br>
+ * -------------------------------------------------------<br>
+ * @return Number of records written.
+ */
+size_t Printer::flushRings() {
+    vector<SpscRing*> snapshot;
+    pthread_mutex_lock(&instance.ringsLock);
+    for (unique_ptr<SpscRing>& ring : instance.rings) snapshot.push_back(ring.get());
+    pthread_mutex_unlock(&instance.ringsLock);
+
+    string toCout, toCerr, toFile;
+    size_t count = 0;
+    for (SpscRing* ring : snapshot) {
+        count += ring->drain([&](uint32_t tag, const char* a, size_t aLen, const char* b, size_t bLen) {
+            string& batch = tag == TO_CERR ? toCerr : toCout;
+            batch.append(a, aLen).append(b, bLen);
+            toFile.append(a, aLen).append(b, bLen);
+        });
+    }
+    if (count == 0) return 0;
+
+    pthread_mutex_lock(&instance.lock);
+    cout << toCout << flush;
+    cerr << toCerr;
+    instance.file << toFile << flush;
+    pthread_mutex_unlock(&instance.lock);
+    return count;
+}
+
+/**
+ * Flusher thread main loop.<br>
+ * -------------------------------------------------------<br>
+ * - Drains the rings, sleeping briefly whenever they were all empty.<br>
+ * - Exits after one last drain once stopping is set.<br>
+ * -------------------------------------------------------<br>
+ */
+void* Printer::flushMain(void*) {
+    while (!instance.stopping.load(memory_order_acquire)) {
+        if (flushRings() == 0) usleep(1000);
+    }
+    flushRings();
+    return nullptr;
+}
+
+/**
+ * Starts asynchronous logging.<br>
+ * -------------------------------------------------------<br>
+ * - Launches the flusher thread; later writes are queued per thread.<br>
+ * - Calling it twice has no effect.<br>
+ * -------------------------------------------------------<br>
+ */
+void Printer::startAsync() {
+    if (instance.async.load()) return;
+    instance.stopping.store(false);
+    if (pthread_create(&instance.flusher, nullptr, flushMain, nullptr)) {
+        cerr << "ERROR; failed to create printer thread, staying synchronous\n";
+        return;
+    }
+    instance.async.store(true, memory_order_release);
+}
+
+/**
+ * Stops asynchronous logging.<br>
+ * -------------------------------------------------------<br>
+ * - Switches writers back to the direct path, then lets the flusher
+ *   drain whatever is left and joins it.<br>
+ * - Call once writer threads are done; rings stay allocated until the
+ *   Printer is destroyed because threads keep pointers to them.<br>
+ * -------------------------------------------------------<br>
+ */
+void Printer::stopAsync() {
+    if (!instance.async.exchange(false)) return;
+    instance.stopping.store(true, memory_order_release);
+    pthread_join(instance.flusher, nullptr);
+    flushRings();
+}
+
 /**
  * Writes a message to both the output stream and the log file.<br>
  * -------------------------------------------------------<br>
@@ -29,8 +174,8 @@ Printer::Printer() {
  * -------------------------------------------------------<br>
  */
 void Printer::write(const string& message , ostream& out) {
-    out<<message;
-    instance.file << message;
+    if (instance.async.load(memory_order_acquire)) enqueue(message.data(), message.size(), out);
+    else writeDirect(message.data(), message.size(), out);
 }
 
 
@@ -39,14 +184,16 @@ void Printer::write(const string& message , ostream& out) {
  * -------------------------------------------------------
  * - Outputs the contents of the stream to the given `ostream` (e.g., `cout`).
  * - Also writes the same content to an internal log file.
+ * - In async mode the content is only copied into the thread's ring.
  * - Clears the stringstream after writing to avoid duplication.
  * -------------------------------------------------------
  * @param stream Reference to the stringstream holding the content.<br>
  * @param out Output stream to write to (e.g., `cout`, `cerr`).<br>
  */
 void Printer::write(stringstream& stream , ostream& out) {
-    out<<stream.str();
-    instance.file << stream.str();
+    string_view text = stream.view();
+    if (instance.async.load(memory_order_acquire)) enqueue(text.data(), text.size(), out);
+    else writeDirect(text.data(), text.size(), out);
     stream.str("");
     stream.clear();
 }
@@ -62,18 +209,21 @@ void Printer::write(stringstream& stream , ostream& out) {
  * @param out Output stream to write to (e.g., `cout`, `cerr`).
  */
 void Printer::writeln(const string& message , ostream& out) {
-    out<<message<<'\n';
-    instance.file << message<<'\n';
+    write(message + '\n', out);
 }
 
 /**
  * Destructor for the Printer class.<br>
  * -------------------------------------------------------<br>
+ * - Stops the flusher thread if async logging is still on.<br>
  * - Closes the log file stream to ensure all buffered output is written.<br>
  * - Automatically invoked when the `Printer` instance is destroyed.<br>
  * -------------------------------------------------------<br>
  */
 Printer::~Printer()
 {
+    stopAsync();
     instance.file.close();
-}
\ No newline at end of file
+    pthread_mutex_destroy(&ringsLock);
+    pthread_mutex_destroy(&lock);
+}
@@ -6,18 +6,49 @@
 
 #pragma once
 #include "tools.hpp"
+#include "SpscRing.hpp"
 
 class Printer {
 private:
     ofstream file;                    // Output file stream
     static Printer instance;         // Singleton instance
+    pthread_mutex_t lock;            // Serializes direct (synchronous) writes
+
+    // Async mode: every writing thread owns one ring, a flusher thread drains them all
+    atomic<bool> async{false};       // True while the flusher thread is running
+    atomic<bool> stopping{false};    // Asks the flusher to drain once more and exit
+    pthread_t flusher{};             // Background thread that empties the rings
+    pthread_mutex_t ringsLock;       // Guards rings (registration only)
+    vector<unique_ptr<SpscRing>> rings;  // Every ring ever handed out, freed at stop
+
     Printer();                       // Private constructor
     ~Printer();                      // Private destructor
 
+    // Writes straight to the stream and file under the lock
+    static void writeDirect(const char* data, size_t length, ostream& out);
+
+    // Copies a message into the calling thread's ring, or writes it directly when it cannot be queued
+    static void enqueue(const char* data, size_t length, ostream& out);
+
+    // Returns the calling thread's ring, registering a new one on first use
+    static SpscRing& threadRing();
+
+    // Drains every ring once into batches and writes them out; returns records drained
+    static size_t flushRings();
+
+    // Flusher thread body
+    static void* flushMain(void*);
+
 public:
     // Assign control of output file stream (used if needed externally)
     static void getControl(ofstream&& out) { instance.file = move(out); }
 
+    // Switch to asynchronous logging: writes go to per-thread rings drained by a flusher thread
+    static void startAsync();
+
+    // Drain everything still queued, stop the flusher and return to synchronous writes
+    static void stopAsync();
+
     // Print a message to both the output file and provided output stream
     static void write(const string& message, ostream& out);
 
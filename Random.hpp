@@ -0,0 +1,82 @@
+#pragma once
+#include "tools.hpp"
+
+/**
+ * Rng class<br>
+ * ------------------------------------------------------<br>
+ * - xoshiro256** generator: 32 bytes of state, no locks, no shared state.<br>
+ * - A run seed plus a stream number gives an independent generator:
+ *   Mom draws from stream 0 and Kid i from stream i + 1, so a run
+ *   replays exactly from the seed it printed.<br>
+ * - local() is a per-thread generator; Mom reseeds its own at startup.<br>
+ * - fill() produces a batch of small ratings, four per 64-bit draw.<br>
+ */
+class Rng {
+private:
+    uint64_t state[4];
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    /** splitmix64 step, used to expand a seed into the four state words */
+    static uint64_t splitmix(uint64_t& x) {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+public:
+    /** Seeds a stream<br>
+     * @param seed Run seed
+     * @param stream Stream number, hashed into the seed before expansion
+     */
+    explicit Rng(uint64_t seed = 0, uint64_t stream = 0) {
+        uint64_t mixed = stream;
+        uint64_t x = seed ^ splitmix(mixed);
+        for (uint64_t& word : state) word = splitmix(x);
+    }
+
+    /** Returns the next 64 random bits */
+    uint64_t next() {
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    /** Returns a number in [low, high] by multiply-shift on 32 random bits */
+    int between(int low, int high) {
+        uint64_t span = uint64_t(high - low) + 1;
+        return low + static_cast<int>(((next() >> 32) * span) >> 32);
+    }
+
+    /** Fills a batch with numbers in [low, high]<br>
+     * Each 64-bit draw is split into four 16-bit lanes, each scaled by multiply-shift.<br>
+     * @param out Destination
+     * @param count Number of values
+     * @param low Smallest value
+     * @param high Largest value
+     */
+    void fill(uint8_t* out, size_t count, uint8_t low, uint8_t high) {
+        uint32_t span = uint32_t(high - low) + 1;
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            uint64_t bits = next();
+            for (int lane = 0; lane < 4; lane++) {
+                out[i + lane] = low + static_cast<uint8_t>(((bits >> (16 * lane) & 0xFFFF) * span) >> 16);
+            }
+        }
+        for (; i < count; i++) out[i] = static_cast<uint8_t>(between(low, high));
+    }
+
+    /** Returns the calling thread's generator */
+    static Rng& local() {
+        thread_local Rng rng;
+        return rng;
+    }
+};
@@ -0,0 +1,45 @@
+#include "SelectionPolicy.hpp"
+#include "Kid.hpp"
+
+/**
+ * Registered strategies<br>
+ * --------------------------------------------------
+ * - A function-local static so registrations from other translation units
+ *   work regardless of static initialization order.
+ * - Index i of the first five entries is Mood i.
+ * @return The strategy list
+ */
+vector<SelectionStrategy>& StrategyRegistry::all() {
+    static vector<SelectionStrategy> strategies = {
+        Kid::strategyFor<LazyPolicy>(),
+        Kid::strategyFor<PrissyPolicy>(),
+        Kid::strategyFor<OvertiredPolicy>(),
+        Kid::strategyFor<CooperativePolicy>(),
+        Kid::strategyFor<GreedyPolicy>(),
+    };
+    return strategies;
+}
+
+/**
+ * Registers a strategy<br>
+ * --------------------------------------------------
+ * @param strategy Record built by Kid::strategyFor
+ * @return Index kids and buckets will use for it
+ */
+int StrategyRegistry::add(const SelectionStrategy& strategy) {
+    all().push_back(strategy);
+    return count() - 1;
+}
+
+/**
+ * Finds a strategy by name<br>
+ * --------------------------------------------------
+ * @param name Name to match, case-insensitively
+ * @return Index of the first strategy with that name, or -1
+ */
+int StrategyRegistry::find(const string& name) {
+    for (int i = 0; i < count(); i++) {
+        if (caseInsensitiveEquals(name, get(i).name)) return i;
+    }
+    return -1;
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include "tools.hpp"
+#include "Enums.hpp"
+#include "Job.hpp"
+#include <concepts>
+
+class Kid;
+
+/**
+ * SelectionPolicy concept<br>
+ * ------------------------------------------------------<br>
+ * - A compile-time description of which jobs a kid will take and in what order it looks.<br>
+ * - name:     printed when a kid adopts the policy.<br>
+ * - mood:     the built-in filter closest to the policy; SCAN mode prefilters with its
+ *             SIMD kernel and eligible() has the final say, so COOPERATIVE is always safe.<br>
+ * - fromEnd:  scan the table from the last slot instead of the first.<br>
+ * - eligible: the filter itself, a static function so it inlines into each selection loop.<br>
+ */
+template <class P>
+concept SelectionPolicy = requires(const Job& job) {
+    { P::name } -> convertible_to<const char*>;
+    { P::mood } -> convertible_to<Mood>;
+    { P::fromEnd } -> convertible_to<bool>;
+    { P::eligible(job) } -> same_as<bool>;
+};
+
+/** LAZY kids skip heavy jobs */
+struct LazyPolicy {
+    static constexpr const char* name = "LAZY";
+    static constexpr Mood mood = Mood::LAZY;
+    static constexpr bool fromEnd = false;
+    static bool eligible(const Job& job) { return job.getHeavy() < 3; }
+};
+
+/** PRISSY kids skip dirty jobs */
+struct PrissyPolicy {
+    static constexpr const char* name = "PRISSY";
+    static constexpr Mood mood = Mood::PRISSY;
+    static constexpr bool fromEnd = false;
+    static bool eligible(const Job& job) { return job.getDirty() < 3; }
+};
+
+/** OVERTIRED kids skip slow jobs */
+struct OvertiredPolicy {
+    static constexpr const char* name = "OVERTIRED";
+    static constexpr Mood mood = Mood::OVERTIRED;
+    static constexpr bool fromEnd = false;
+    static bool eligible(const Job& job) { return job.getSlow() < 3; }
+};
+
+/** COOPERATIVE kids take anything, starting from the end of the table */
+struct CooperativePolicy {
+    static constexpr const char* name = "COOPERATIVE";
+    static constexpr Mood mood = Mood::COOPERATIVE;
+    static constexpr bool fromEnd = true;
+    static bool eligible(const Job&) { return true; }
+};
+
+/** GREEDY kids only take valuable jobs */
+struct GreedyPolicy {
+    static constexpr const char* name = "GREEDY";
+    static constexpr Mood mood = Mood::GREEDY;
+    static constexpr bool fromEnd = false;
+    static bool eligible(const Job& job) { return job.getValue() > 40; }
+};
+
+/**
+ * SelectionStrategy struct<br>
+ * ------------------------------------------------------<br>
+ * - Runtime record of one policy, built by Kid::strategyFor<P>().<br>
+ * - select holds one Kid member per SchedMode, each instantiated for the policy,
+ *   so a kid dispatches once per selection and never branches on its mood.<br>
+ */
+struct SelectionStrategy {
+    const char* name;                    ///< Policy name, printed instead of the mood
+    Mood mood;                           ///< Built-in filter the policy maps to
+    bool (*eligible)(const Job&);        ///< Filter used by Mom when routing jobs
+    void (Kid::*select[4])();            ///< Selection path per SchedMode
+};
+
+/**
+ * StrategyRegistry class<br>
+ * ------------------------------------------------------<br>
+ * - Every strategy a kid can roll; the five moods come first, in Mood order.<br>
+ * - Extra strategies are added before main() runs with REGISTER_SELECTION_POLICY
+ *   (see Kid.hpp), from any translation unit linked into the program.<br>
+ * - The list must not change once a JobTable exists, since buckets are sized from it.<br>
+ */
+class StrategyRegistry {
+private:
+    /** The registered strategies, seeded with the built-in moods on first use */
+    static vector<SelectionStrategy>& all();
+
+public:
+    /** Adds a strategy<br>
+     * @param strategy Record built by Kid::strategyFor<br>
+     * @return Index of the strategy
+     */
+    static int add(const SelectionStrategy& strategy);
+
+    /** Looks a strategy up by index<br>
+     * @param index Value returned by add(), or a Mood cast to int
+     * @return The strategy
+     */
+    static const SelectionStrategy& get(int index) { return all()[index]; }
+
+    /** Looks a strategy up by name, ignoring case<br>
+     * @param name Strategy name, e.g. "lazy"
+     * @return Index of the strategy, or -1 if none has that name
+     */
+    static int find(const string& name);
+
+    /** Returns the number of registered strategies */
+    static int count() { return static_cast<int>(all().size()); }
+};
@@ -0,0 +1,255 @@
+#include "ShmTable.hpp"
+#include "Metrics.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+
+/** How long a parked worker sleeps before looking at quit again, in case Mom died */
+static const long parkMillis = 100;
+
+/** Destructor: unmaps the segment if close() was never called */
+ShmTable::~ShmTable() {
+    close();
+}
+
+/**
+ * Creates the segment<br>
+ * --------------------------------------------------
+ * - O_EXCL: a leftover segment of the same name is an error, not something to reuse.
+ * - The lock and condition variable are PTHREAD_PROCESS_SHARED and the lock is
+ *   robust; the semaphore is process-shared. All of them live in the segment.
+ * @return true on success
+ */
+bool ShmTable::create(const string& segment, int slots, int kids, long tick) {
+    name = segment;
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) return false;
+    owner = true;
+    bytes = segmentBytes(kids, slots);
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        ::close(fd);
+        return false;
+    }
+    void* mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) return false;
+    base = mapped;
+
+    // ftruncate zero-fills, so every slot starts EMPTY and every counter at 0
+    ShmHeader& head = header();
+    head.slots = static_cast<uint32_t>(slots);
+    head.kids = static_cast<uint32_t>(kids);
+    head.tick = tick;
+    head.mom = getpid();
+    pthread_mutexattr_t lockAttr;
+    pthread_mutexattr_init(&lockAttr);
+    pthread_mutexattr_setpshared(&lockAttr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&lockAttr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&head.lock, &lockAttr);
+    pthread_mutexattr_destroy(&lockAttr);
+    pthread_condattr_t condAttr;
+    pthread_condattr_init(&condAttr);
+    pthread_condattr_setpshared(&condAttr, PTHREAD_PROCESS_SHARED);
+    pthread_cond_init(&head.posted, &condAttr);
+    pthread_condattr_destroy(&condAttr);
+    sem_init(&head.done, 1, 0);
+    for (int i = 0; i < slots; i++) slot(i).kid = -1;
+    memcpy(head.magic, "TDSHM001", 8);
+    return true;
+}
+
+/**
+ * Attaches to a segment<br>
+ * --------------------------------------------------
+ * - The mapping lands wherever this process has room; nothing in the
+ *   segment depends on where Mom mapped it.
+ * @return true on success
+ */
+bool ShmTable::attach(const string& segment) {
+    name = segment;
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) return false;
+    bool mapped = map(fd);
+    ::close(fd);
+    return mapped;
+}
+
+/** Maps the whole segment and checks the magic and the size the header implies */
+bool ShmTable::map(int fd) {
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(ShmHeader)) return false;
+    bytes = static_cast<size_t>(info.st_size);
+    void* mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) return false;
+    base = mapped;
+    if (memcmp(header().magic, "TDSHM001", 8) != 0 || segmentBytes(header().kids, header().slots) > bytes) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+/** Unmaps; Mom also destroys the shared primitives and unlinks the name */
+void ShmTable::close() {
+    if (base != nullptr) {
+        if (owner) {
+            sem_destroy(&header().done);
+            pthread_cond_destroy(&header().posted);
+            pthread_mutex_destroy(&header().lock);
+        }
+        munmap(base, bytes);
+        base = nullptr;
+    }
+    if (owner) {
+        shm_unlink(name.c_str());
+        owner = false;
+    }
+}
+
+/** Locks the table */
+void ShmTable::lock() {
+    if (pthread_mutex_lock(&header().lock) == EOWNERDEAD) repair();
+}
+
+/**
+ * Repairs the table after a worker died holding the lock<br>
+ * --------------------------------------------------
+ * - The worker died inside complete(). Its slot may be DONE without having
+ *   reached the ring, so every DONE slot missing from the ring is queued
+ *   before the lock is marked consistent.
+ */
+void ShmTable::repair() {
+    ShmHeader& head = header();
+    vector<bool> queued(head.slots);
+    for (uint64_t at = head.doneHead; at < head.doneTail; at++) queued[ring()[at % head.slots]] = true;
+    for (uint32_t i = 0; i < head.slots; i++) {
+        if (!queued[i] && slot(static_cast<int>(i)).state.load(memory_order_acquire) == static_cast<uint32_t>(SlotState::DONE)) {
+            ring()[head.doneTail++ % head.slots] = i;
+            sem_post(&head.done);
+        }
+    }
+    pthread_mutex_consistent(&head.lock);
+}
+
+/**
+ * Fills a slot<br>
+ * --------------------------------------------------
+ * - The release store of READY publishes the fields to any worker whose
+ *   claiming CAS reads it.
+ */
+void ShmTable::fill(int index, const uint8_t ratings[3], uint64_t eligible) {
+    ShmSlot& job = slot(index);
+    job.kid = -1;
+    job.slow = ratings[0];
+    job.dirty = ratings[1];
+    job.heavy = ratings[2];
+    job.value = ratings[0] * (ratings[1] + ratings[2]);
+    job.eligible = eligible;
+    job.postedNs = Metrics::now();
+    job.state.store(static_cast<uint32_t>(SlotState::READY), memory_order_release);
+}
+
+/** Counts a post and wakes the parked workers */
+void ShmTable::publish() {
+    lock();
+    header().posts++;
+    pthread_cond_broadcast(&header().posted);
+    unlock();
+}
+
+/**
+ * Claims a job<br>
+ * --------------------------------------------------
+ * - Scans from the cursor, wrapping once, so workers spread out over the table
+ *   instead of all fighting over its first ready slot.
+ * - The eligible mask is checked before the CAS; the mask is only rewritten
+ *   while the slot is not READY, so it cannot change under a winning CAS. The
+ *   acquire load orders the mask read after Mom's fill.
+ * - The claimer goes into the CAS itself, so a worker killed right after it
+ *   still leaves a slot reclaim() finds.
+ */
+int ShmTable::claim(int kidId, uint64_t strategyBit, uint32_t& cursor) {
+    uint32_t slots = header().slots;
+    for (uint32_t k = 0; k < slots; k++) {
+        uint32_t i = (cursor + k) % slots;
+        ShmSlot& job = slot(static_cast<int>(i));
+        uint32_t expected = static_cast<uint32_t>(SlotState::READY);
+        if (job.state.load(memory_order_acquire) != expected || (job.eligible & strategyBit) == 0) continue;
+        if (!job.state.compare_exchange_strong(expected, claimedBy(kidId), memory_order_acquire)) continue;
+        job.kid = kidId;
+        cursor = (i + 1) % slots;
+        return static_cast<int>(i);
+    }
+    return -1;
+}
+
+/**
+ * Parks a worker<br>
+ * --------------------------------------------------
+ * - The wait is bounded, so a worker whose Mom was killed still finds out.
+ */
+bool ShmTable::waitForPost(uint64_t& seen) {
+    ShmHeader& head = header();
+    lock();
+    while (head.quit.load() == 0 && head.posts == seen && getppid() == head.mom) {
+        timespec until;
+        clock_gettime(CLOCK_REALTIME, &until);
+        long ns = until.tv_nsec + parkMillis * 1000000;
+        until.tv_sec += ns / 1000000000;
+        until.tv_nsec = ns % 1000000000;
+        if (pthread_cond_timedwait(&head.posted, &head.lock, &until) == EOWNERDEAD) repair();
+    }
+    seen = head.posts;
+    unlock();
+    return head.quit.load() == 0 && getppid() == head.mom;
+}
+
+/**
+ * Completes a slot<br>
+ * --------------------------------------------------
+ * - DONE is stored before the slot is queued; repair() covers a worker dying between the two.
+ */
+void ShmTable::complete(int index) {
+    ShmHeader& head = header();
+    lock();
+    slot(index).state.store(static_cast<uint32_t>(SlotState::DONE), memory_order_release);
+    ring()[head.doneTail++ % head.slots] = static_cast<uint32_t>(index);
+    unlock();
+    sem_post(&head.done);
+}
+
+/** Empties the done ring into a list */
+void ShmTable::drain(vector<int>& into) {
+    ShmHeader& head = header();
+    lock();
+    for (; head.doneHead < head.doneTail; head.doneHead++) into.push_back(static_cast<int>(ring()[head.doneHead % head.slots]));
+    unlock();
+}
+
+/**
+ * Reclaims a dead worker's jobs<br>
+ * --------------------------------------------------
+ * - Only called once waitpid has reaped the worker, so nothing else writes its slots.
+ * - Slots are matched by their state word, which names the claimer even if
+ *   the worker died before storing kid.
+ * - The jobs keep their post time, so their wait covers the time lost to the crash.
+ */
+int ShmTable::reclaim(int kidId) {
+    int returned = 0;
+    for (uint32_t i = 0; i < header().slots; i++) {
+        ShmSlot& job = slot(static_cast<int>(i));
+        if (job.state.load(memory_order_acquire) != claimedBy(kidId)) continue;
+        job.kid = -1;
+        job.state.store(static_cast<uint32_t>(SlotState::READY), memory_order_release);
+        returned++;
+    }
+    if (returned > 0) publish();
+    return returned;
+}
+
+/** Sets quit and wakes every parked worker */
+void ShmTable::stop() {
+    header().quit.store(1);
+    lock();
+    pthread_cond_broadcast(&header().posted);
+    unlock();
+}
@@ -0,0 +1,184 @@
+#pragma once
+#include "tools.hpp"
+#include <atomic>
+#include <cstdint>
+#include <semaphore.h>
+
+/** State of a shared-memory slot, the low byte of ShmSlot::state */
+enum class SlotState : uint32_t { EMPTY, READY, CLAIMED, DONE };
+
+/** State word of a slot claimed by a kid: CLAIMED, with the kid above the low byte */
+inline uint32_t claimedBy(int kidId) { return static_cast<uint32_t>(SlotState::CLAIMED) | static_cast<uint32_t>(kidId) << 8; }
+
+/**
+ * ShmSlot struct<br>
+ * ------------------------------------------------------<br>
+ * - One job of the shared table, 32 bytes, with no pointers: every process
+ *   maps the segment at its own address, so records only hold values and indexes.<br>
+ * - Mom fills the ratings and eligible mask, then publishes the slot by storing
+ *   READY; a worker claims it by a CAS from READY to claimedBy(kid), so the
+ *   claimer is known the moment the slot leaves READY.<br>
+ */
+struct ShmSlot {
+    atomic<uint32_t> state;    ///< SlotState, or claimedBy(kid) while claimed
+    int32_t kid;               ///< Kid that claimed the job, -1 while unclaimed; read by Mom once DONE
+    uint8_t slow;              ///< Slow rating, 1 to 5
+    uint8_t dirty;             ///< Dirty rating, 1 to 5
+    uint8_t heavy;             ///< Heavy rating, 1 to 5
+    uint8_t reserved;          ///< Zero
+    int32_t value;             ///< Job value, slow x (dirty + heavy)
+    uint64_t eligible;         ///< Bit s set if StrategyRegistry strategy s takes the job
+    uint64_t postedNs;         ///< Metrics::now() when Mom posted the job
+};
+static_assert(sizeof(ShmSlot) == 32, "ShmSlot must stay 32 bytes");
+static_assert(atomic<uint32_t>::is_always_lock_free, "slot states must be lock-free to be shared between processes");
+
+/**
+ * ShmKid struct<br>
+ * ------------------------------------------------------<br>
+ * - One worker's counters, on a cache line of its own; only that worker writes them.<br>
+ * - Mom reads claims while the worker runs, the waits once it has exited.<br>
+ */
+struct alignas(64) ShmKid {
+    atomic<int64_t> claims;    ///< Jobs claimed
+    uint64_t waitNs;           ///< Nanoseconds claimed jobs had waited since being posted
+    uint64_t maxWaitNs;        ///< Longest wait of any claimed job
+};
+static_assert(atomic<int64_t>::is_always_lock_free, "kid counters must be lock-free to be shared between processes");
+
+/**
+ * ShmHeader struct<br>
+ * ------------------------------------------------------<br>
+ * - Start of the segment; ShmKid records, ShmSlot records and the done ring follow.<br>
+ * - The mutex is process-shared and robust: a worker that dies holding it
+ *   leaves it to the next locker instead of deadlocking everyone.<br>
+ */
+struct ShmHeader {
+    char magic[8];             ///< "TDSHM001"
+    uint32_t slots;            ///< Table slots
+    uint32_t kids;             ///< Worker processes
+    int64_t tick;              ///< Microseconds a worker sleeps per unit of slow
+    int32_t mom;               ///< Mom's pid; a worker that outlives her stops
+    pthread_mutex_t lock;      ///< Guards posts, the done ring and waiting on posted
+    pthread_cond_t posted;     ///< Broadcast when Mom posts jobs or stops the workers
+    sem_t done;                ///< Posted once per completed job, Mom waits on it
+    uint64_t posts;            ///< Batches Mom has posted, under lock
+    uint64_t doneHead;         ///< Next done ring entry Mom reads, under lock
+    uint64_t doneTail;         ///< Next done ring entry a worker writes, under lock
+    atomic<uint32_t> quit;     ///< Set by Mom to stop the workers at a job boundary
+};
+
+/**
+ * ShmTable class<br>
+ * ------------------------------------------------------<br>
+ * - The job table of --processes: a POSIX shared-memory segment Mom creates
+ *   and each worker process maps by name.<br>
+ * - Claims are lock-free: a worker scans for a READY slot its strategy takes
+ *   and CASes it to CLAIMED. The lock is only taken to park when nothing is
+ *   claimable and to queue a completed slot for Mom.<br>
+ * - Completed slots go through a ring of slot indexes, one entry per slot at
+ *   most, and wake Mom through a process-shared semaphore.<br>
+ * - A worker that dies leaves its claimed slots CLAIMED; Mom puts them back
+ *   with reclaim(), so one crash costs a job, not the run.<br>
+ */
+class ShmTable {
+private:
+    string name;                     ///< shm_open name
+    void* base = nullptr;            ///< This process's mapping
+    size_t bytes = 0;                ///< Segment size
+    bool owner = false;              ///< True in Mom, who unlinks the segment
+
+    /** Byte offsets of the kid records, slots and done ring, and the segment size */
+    static size_t kidsAt() { return (sizeof(ShmHeader) + 63) / 64 * 64; }
+    static size_t slotsAt(size_t kids) { return kidsAt() + kids * sizeof(ShmKid); }
+    static size_t ringAt(size_t kids, size_t slots) { return slotsAt(kids) + slots * sizeof(ShmSlot); }
+    static size_t segmentBytes(size_t kids, size_t slots) { return ringAt(kids, slots) + slots * sizeof(uint32_t); }
+
+    /** Maps the segment and checks its header<br>
+     * @param fd Open segment
+     * @return false if it cannot be mapped or is not a table
+     */
+    bool map(int fd);
+
+    /** Requeues completions a dead lock owner left half done, and marks the lock consistent */
+    void repair();
+
+public:
+    ShmTable() = default;
+    ~ShmTable();
+
+    ShmTable(const ShmTable&) = delete;
+    ShmTable& operator=(const ShmTable&) = delete;
+
+    /** Creates and initializes a segment; Mom only<br>
+     * @param segment Name for shm_open, starting with a slash
+     * @param slots Config::tableSize
+     * @param kids Config::kids
+     * @param tick Config::tick
+     * @return false if the segment cannot be created
+     */
+    bool create(const string& segment, int slots, int kids, long tick);
+
+    /** Maps an existing segment; workers<br>
+     * @param segment Name Mom created it under
+     * @return false if it cannot be opened or is not a table
+     */
+    bool attach(const string& segment);
+
+    /** Unmaps the segment, and unlinks it in Mom */
+    void close();
+
+    ShmHeader& header() const { return *static_cast<ShmHeader*>(base); }
+    ShmKid& kid(int id) const { return reinterpret_cast<ShmKid*>(static_cast<char*>(base) + kidsAt())[id]; }
+    ShmSlot& slot(int index) const { return reinterpret_cast<ShmSlot*>(static_cast<char*>(base) + slotsAt(header().kids))[index]; }
+    uint32_t* ring() const { return reinterpret_cast<uint32_t*>(static_cast<char*>(base) + ringAt(header().kids, header().slots)); }
+    size_t size() const { return bytes; }
+
+    /** Locks the table, repairing the lock if its last owner died */
+    void lock();
+    void unlock() { pthread_mutex_unlock(&header().lock); }
+
+    /** Fills a slot and makes it claimable; Mom only<br>
+     * Workers are not woken until publish().
+     * @param index Slot
+     * @param ratings Slow, dirty and heavy
+     * @param eligible Strategies that take the job, one bit per StrategyRegistry index
+     */
+    void fill(int index, const uint8_t ratings[3], uint64_t eligible);
+
+    /** Wakes every parked worker after a batch of fill() calls */
+    void publish();
+
+    /** Claims a job for a worker<br>
+     * @param kidId Claiming kid
+     * @param strategyBit Bit of the kid's strategy in ShmSlot::eligible
+     * @param cursor Slot the scan starts at, moved past the claimed slot
+     * @return Claimed slot, -1 if nothing claimable is posted
+     */
+    int claim(int kidId, uint64_t strategyBit, uint32_t& cursor);
+
+    /** Parks a worker until Mom posts after seen, or stops the workers<br>
+     * @param seen Posts the worker last looked at; updated
+     * @return false once the workers are stopped
+     */
+    bool waitForPost(uint64_t& seen);
+
+    /** Marks a claimed slot done, queues it for Mom and wakes her<br>
+     * @param index Slot
+     */
+    void complete(int index);
+
+    /** Takes every queued completed slot; Mom only<br>
+     * @param into Receives slot indexes
+     */
+    void drain(vector<int>& into);
+
+    /** Puts a dead worker's claimed jobs back on the table; Mom only<br>
+     * @param kidId Worker that died
+     * @return Jobs put back
+     */
+    int reclaim(int kidId);
+
+    /** Tells every worker to stop after its current job */
+    void stop();
+};
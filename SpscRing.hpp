@@ -0,0 +1,105 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+/**
+ * SpscRing class<br>
+ * ------------------------------------------------------<br>
+ * - Lock-free single-producer/single-consumer ring of variable-length records.<br>
+ * - Each record is an 8-byte header (length, tag) followed by its bytes.<br>
+ * - Records may wrap around the end of the buffer; copies are split in two.<br>
+ * - The producer only writes tail and the consumer only writes head,
+ *   so neither side ever blocks the other.<br>
+ */
+class SpscRing {
+private:
+    /** Record header stored in front of every payload */
+    struct Header {
+        uint32_t length;    ///< Payload size in bytes
+        uint32_t tag;       ///< Caller-defined label, e.g. which stream
+    };
+
+    std::unique_ptr<char[]> buffer;             ///< Ring storage
+    size_t mask;                                ///< Capacity - 1, capacity is a power of two
+    alignas(64) std::atomic<size_t> head{0};    ///< Consumer position (bytes consumed)
+    alignas(64) std::atomic<size_t> tail{0};    ///< Producer position (bytes published)
+
+    /** Copies bytes into the ring starting at a position, wrapping if needed */
+    void copyIn(size_t pos, const void* src, size_t n) {
+        size_t at = pos & mask;
+        size_t first = n < capacity() - at ? n : capacity() - at;
+        memcpy(buffer.get() + at, src, first);
+        memcpy(buffer.get(), static_cast<const char*>(src) + first, n - first);
+    }
+
+    /** Copies bytes out of the ring starting at a position, wrapping if needed */
+    void copyOut(size_t pos, void* dst, size_t n) const {
+        size_t at = pos & mask;
+        size_t first = n < capacity() - at ? n : capacity() - at;
+        memcpy(dst, buffer.get() + at, first);
+        memcpy(static_cast<char*>(dst) + first, buffer.get(), n - first);
+    }
+
+public:
+    /** Constructor<br>
+     * @param capacity Size in bytes, rounded up to a power of two
+     */
+    explicit SpscRing(size_t capacity) {
+        size_t size = 64;
+        while (size < capacity) size <<= 1;
+        buffer.reset(new char[size]);
+        mask = size - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /** Total size of the ring in bytes */
+    size_t capacity() const { return mask + 1; }
+
+    /** Largest payload that can ever fit */
+    size_t maxRecord() const { return capacity() - sizeof(Header); }
+
+    /** Producer only: appends one record<br>
+     * @param tag Label handed back to the consumer<br>
+     * @param data Payload bytes<br>
+     * @param length Payload size<br>
+     * @return false when the ring does not have room right now
+     */
+    bool push(uint32_t tag, const char* data, size_t length) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t need = sizeof(Header) + length;
+        if (need > capacity() - (t - head.load(std::memory_order_acquire))) return false;
+        Header header{static_cast<uint32_t>(length), tag};
+        copyIn(t, &header, sizeof header);
+        copyIn(t + sizeof header, data, length);
+        tail.store(t + need, std::memory_order_release);
+        return true;
+    }
+
+    /** Consumer only: hands every published record to a sink<br>
+     * The sink is called as sink(tag, first, firstLength, second, secondLength);
+     * the second span is non-empty only when the payload wraps.<br>
+     * @param sink Callback receiving each record<br>
+     * @return Number of records drained
+     */
+    template <typename Sink>
+    size_t drain(Sink&& sink) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t t = tail.load(std::memory_order_acquire);
+        size_t count = 0;
+        while (h != t) {
+            Header header;
+            copyOut(h, &header, sizeof header);
+            size_t at = (h + sizeof header) & mask;
+            size_t first = header.length < capacity() - at ? header.length : capacity() - at;
+            sink(header.tag, buffer.get() + at, first, buffer.get(), header.length - first);
+            h += sizeof header + header.length;
+            count++;
+        }
+        head.store(h, std::memory_order_release);
+        return count;
+    }
+};
@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * StealDeque class<br>
+ * ------------------------------------------------------<br>
+ * - Chase-Lev work-stealing deque (Le et al., PPoPP 2013 memory orderings).<br>
+ * - The owning kid pushes and pops at the bottom without locking.<br>
+ * - Other kids steal from the top with a single CAS.<br>
+ * - The ring doubles when full; retired rings live until the deque dies
+ *   because a thief may still be reading one.<br>
+ * - T must be a trivially copyable value whose T{} means "nothing".<br>
+ */
+template <typename T>
+class StealDeque {
+private:
+    /** Power-of-two ring of atomics indexed modulo its capacity */
+    struct Ring {
+        int64_t capacity;
+        std::unique_ptr<std::atomic<T>[]> items;
+
+        explicit Ring(int64_t capacity): capacity(capacity), items(new std::atomic<T>[capacity]) {}
+        T get(int64_t i) const { return items[i & (capacity - 1)].load(std::memory_order_relaxed); }
+        void put(int64_t i, T x) { items[i & (capacity - 1)].store(x, std::memory_order_relaxed); }
+    };
+
+    alignas(64) std::atomic<int64_t> top{0};       ///< Next index thieves take
+    alignas(64) std::atomic<int64_t> bottom{0};    ///< Next index the owner fills
+    std::atomic<Ring*> ring;                        ///< Current ring
+    std::vector<std::unique_ptr<Ring>> rings;       ///< Every ring ever allocated (owner only)
+
+    /** Doubles the ring, copying the live range [t, b) */
+    Ring* grow(Ring* old, int64_t b, int64_t t) {
+        rings.push_back(std::make_unique<Ring>(old->capacity * 2));
+        Ring* bigger = rings.back().get();
+        for (int64_t i = t; i < b; i++) bigger->put(i, old->get(i));
+        ring.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+
+public:
+    /** Constructor<br>
+     * @param capacity Initial ring size, rounded up to a power of two
+     */
+    explicit StealDeque(int64_t capacity = 64) {
+        int64_t size = 1;
+        while (size < capacity) size <<= 1;
+        rings.push_back(std::make_unique<Ring>(size));
+        ring.store(rings.back().get(), std::memory_order_relaxed);
+    }
+
+    StealDeque(const StealDeque&) = delete;
+    StealDeque& operator=(const StealDeque&) = delete;
+
+    /** Owner only: pushes an item at the bottom */
+    void push(T x) {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        Ring* r = ring.load(std::memory_order_relaxed);
+        if (b - t > r->capacity - 1) r = grow(r, b, t);
+        r->put(b, x);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    /** Owner only: pops the most recently pushed item<br>
+     * @return The item, or T{} when the deque is empty
+     */
+    T pop() {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Ring* r = ring.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+        T x{};
+        if (t <= b) {
+            x = r->get(b);
+            if (t == b) {
+                if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) x = T{};
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+        } else {
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return x;
+    }
+
+    /** Any thread: takes the oldest item if it passes a filter<br>
+     * The item is only looked at, never removed, when the filter rejects it.<br>
+     * @param accept Predicate the thief applies before committing<br>
+     * @return The stolen item, or T{} if empty, rejected or lost to a race
+     */
+    template <typename Pred>
+    T steal(Pred accept) {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b) return T{};
+        T x = ring.load(std::memory_order_acquire)->get(t);
+        if (!accept(x)) return T{};
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return T{};
+        return x;
+    }
+
+    /** Approximate number of items, exact when called by the owner */
+    int64_t size() const {
+        return bottom.load(std::memory_order_relaxed) - top.load(std::memory_order_relaxed);
+    }
+};
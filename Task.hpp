@@ -0,0 +1,131 @@
+#pragma once
+#include "tools.hpp"
+#include <concepts>
+#include <cstddef>
+#include <optional>
+#include <type_traits>
+
+/**
+ * Task class<br>
+ * ------------------------------------------------------<br>
+ * - Move-only, type-erased callable a Job carries as its actual work.<br>
+ * - Callables up to inlineSize bytes that move without throwing live in an
+ *   inline buffer, so building, moving and running them never allocates;
+ *   bigger ones are moved to the heap once.<br>
+ * - A callable returning a number fills the caller's result slot, one
+ *   returning void leaves it empty.<br>
+ * - Dispatch goes through one static table of function pointers per
+ *   callable type, not a virtual base class.<br>
+ */
+class Task {
+public:
+    static constexpr size_t inlineSize = 48;  ///< Capture bytes stored without allocating
+
+private:
+    /** Operations on the stored callable, one table per callable type and storage kind */
+    struct Ops {
+        bool (*invoke)(void* storage, int64_t& result);  ///< Runs it; true if it produced a result
+        void (*move)(void* from, void* to);              ///< Move-constructs into to, destroys from
+        void (*destroy)(void* storage);
+        bool inlined;
+    };
+
+    alignas(max_align_t) unsigned char storage[inlineSize];
+    const Ops* ops = nullptr;
+
+    template <class F>
+    static constexpr bool fitsInline = sizeof(F) <= inlineSize && alignof(F) <= alignof(max_align_t)
+                                       && is_nothrow_move_constructible_v<F>;
+
+    /** Calls f, storing its return value in result when there is one */
+    template <class F>
+    static bool call(F& f, int64_t& result) {
+        if constexpr (is_void_v<invoke_result_t<F&>>) {
+            f();
+            return false;
+        } else {
+            result = static_cast<int64_t>(f());
+            return true;
+        }
+    }
+
+    template <class F>
+    static constexpr Ops inlineOps = {
+        [](void* s, int64_t& result) { return call(*static_cast<F*>(s), result); },
+        [](void* from, void* to) {
+            new (to) F(std::move(*static_cast<F*>(from)));
+            static_cast<F*>(from)->~F();
+        },
+        [](void* s) { static_cast<F*>(s)->~F(); },
+        true,
+    };
+
+    template <class F>
+    static constexpr Ops heapOps = {
+        [](void* s, int64_t& result) { return call(**static_cast<F**>(s), result); },
+        [](void* from, void* to) { *static_cast<F**>(to) = *static_cast<F**>(from); },
+        [](void* s) { delete *static_cast<F**>(s); },
+        false,
+    };
+
+public:
+    /** Empty task; a Job without one is simulated by sleeping */
+    Task() = default;
+
+    /** Wraps a callable<br>
+     * @param f Callable taking no arguments and returning void or a number
+     */
+    template <class F>
+        requires (!same_as<decay_t<F>, Task>) && invocable<decay_t<F>&>
+    Task(F&& f) {
+        using Stored = decay_t<F>;
+        if constexpr (fitsInline<Stored>) {
+            new (storage) Stored(std::forward<F>(f));
+            ops = &inlineOps<Stored>;
+        } else {
+            *reinterpret_cast<Stored**>(storage) = new Stored(std::forward<F>(f));
+            ops = &heapOps<Stored>;
+        }
+    }
+
+    Task(Task&& other) noexcept: ops(other.ops) {
+        if (ops != nullptr) ops->move(other.storage, storage);
+        other.ops = nullptr;
+    }
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            ops = other.ops;
+            if (ops != nullptr) ops->move(other.storage, storage);
+            other.ops = nullptr;
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() { reset(); }
+
+    /** Destroys the stored callable, leaving the task empty */
+    void reset() {
+        if (ops != nullptr) ops->destroy(storage);
+        ops = nullptr;
+    }
+
+    /** True if a callable is stored */
+    explicit operator bool() const { return ops != nullptr; }
+
+    /** True if the callable sits in the inline buffer */
+    bool isInline() const { return ops != nullptr && ops->inlined; }
+
+    /** Runs the callable; the task must not be empty<br>
+     * @return The callable's result, or nothing if it returns void
+     */
+    optional<int64_t> operator()() {
+        int64_t result = 0;
+        if (ops->invoke(storage, result)) return result;
+        return nullopt;
+    }
+};
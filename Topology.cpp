@@ -0,0 +1,127 @@
+#include "Topology.hpp"
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+
+/**
+ * Reads the NUMA layout<br>
+ * --------------------------------------------------
+ * - Every nodeN directory with a readable cpulist is a node; nodes without CPUs are skipped.
+ * - Falls back to a single node 0 holding the online CPUs.
+ * @return Nodes in ascending id order
+ */
+static vector<Topology::Node> discover() {
+    vector<Topology::Node> found;
+    DIR* dir = opendir("/sys/devices/system/node");
+    if (dir != nullptr) {
+        while (dirent* entry = readdir(dir)) {
+            int id;
+            char extra;
+            if (sscanf(entry->d_name, "node%d%c", &id, &extra) != 1) continue;
+            ifstream list("/sys/devices/system/node/" + string(entry->d_name) + "/cpulist");
+            string text;
+            Topology::Node node{id, {}};
+            if (!getline(list, text) || !Topology::parseCpuList(text, node.cpus) || node.cpus.empty()) continue;
+            found.push_back(node);
+        }
+        closedir(dir);
+    }
+    if (found.empty()) {
+        Topology::Node node{0, {}};
+        for (long cpu = 0; cpu < sysconf(_SC_NPROCESSORS_ONLN); cpu++) node.cpus.push_back(static_cast<int>(cpu));
+        found.push_back(node);
+    }
+    sort(found.begin(), found.end(), [](const Topology::Node& a, const Topology::Node& b) { return a.id < b.id; });
+    return found;
+}
+
+/** @return The nodes, read on the first call */
+const vector<Topology::Node>& Topology::nodes() {
+    static const vector<Node> all = discover();
+    return all;
+}
+
+/**
+ * Finds a CPU's node<br>
+ * --------------------------------------------------
+ * @param cpu CPU number
+ * @return Its node id, or -1
+ */
+int Topology::nodeOf(int cpu) {
+    for (const Node& node : nodes()) {
+        if (find(node.cpus.begin(), node.cpus.end(), cpu) != node.cpus.end()) return node.id;
+    }
+    return -1;
+}
+
+/**
+ * Deals CPUs across nodes<br>
+ * --------------------------------------------------
+ * - Takes the first CPU of each node, then the second, and so on.
+ * @return Every CPU once
+ */
+vector<int> Topology::spreadCpus() {
+    vector<int> cpus;
+    for (size_t round = 0;; round++) {
+        size_t before = cpus.size();
+        for (const Node& node : nodes()) {
+            if (round < node.cpus.size()) cpus.push_back(node.cpus[round]);
+        }
+        if (cpus.size() == before) return cpus;
+    }
+}
+
+/**
+ * Parses a CPU list<br>
+ * --------------------------------------------------
+ * - Comma-separated CPUs and inclusive ranges, as in cpulist files and taskset -c.
+ * @param text List to parse
+ * @param cpus Receives the CPUs
+ * @return false on anything else
+ */
+bool Topology::parseCpuList(const string& text, vector<int>& cpus) {
+    stringstream in(text);
+    string part;
+    while (getline(in, part, ',')) {
+        int first, last;
+        char dash, extra;
+        if (sscanf(part.c_str(), "%d%c%d%c", &first, &dash, &last, &extra) == 3 && dash == '-') {
+            if (first < 0 || last < first) return false;
+        } else if (sscanf(part.c_str(), "%d%c", &first, &extra) == 1 && first >= 0) {
+            last = first;
+        } else {
+            return false;
+        }
+        for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+    }
+    return !cpus.empty();
+}
+
+/**
+ * Pins a thread<br>
+ * --------------------------------------------------
+ * @param thread Thread to pin
+ * @param cpu CPU it may run on
+ * @return true on success
+ */
+bool Topology::pin(pthread_t thread, int cpu) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+}
+
+/**
+ * Sets a preferred node for a range<br>
+ * --------------------------------------------------
+ * - mbind with MPOL_PREFERRED, called through syscall() so libnuma is not needed.
+ * - Only pages not yet touched are affected, so call it before writing to the range.
+ * @param memory Page-aligned start
+ * @param bytes Length
+ * @param node Node id
+ */
+void Topology::preferNode(void* memory, size_t bytes, int node) {
+    if (node < 0 || node >= 64) return;
+    unsigned long mask = 1UL << node;
+    syscall(SYS_mbind, memory, bytes, MPOL_PREFERRED, &mask, 64UL, 0U);
+}
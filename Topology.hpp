@@ -0,0 +1,53 @@
+#pragma once
+#include "tools.hpp"
+
+/**
+ * Topology class<br>
+ * ------------------------------------------------------<br>
+ * - NUMA nodes and their CPUs, read once from /sys/devices/system/node.<br>
+ * - Machines without that directory are treated as one node holding every online CPU.<br>
+ * - Pins threads to CPUs and asks the kernel to place memory on a node, so a
+ *   JobTable shard and the kids claiming from it share a socket.<br>
+ * - Static only, like Printer and Metrics.<br>
+ */
+class Topology {
+public:
+    /** One NUMA node */
+    struct Node {
+        int id;              ///< Node number, as in /sys/devices/system/node/node<id>
+        vector<int> cpus;    ///< Its online CPUs, ascending
+    };
+
+    /** Returns the nodes, discovered on first use */
+    static const vector<Node>& nodes();
+
+    /** Returns the node a CPU belongs to, or -1 for a CPU not found on any node */
+    static int nodeOf(int cpu);
+
+    /** Returns every CPU, dealt round-robin across the nodes<br>
+     * Kids taking these in turn are spread evenly over the sockets.
+     */
+    static vector<int> spreadCpus();
+
+    /** Parses a CPU list in the kernel's format, e.g. "0-3,8,10-11"<br>
+     * @param text List to parse
+     * @param cpus Receives the CPUs in the order given
+     * @return false if the text is not a CPU list
+     */
+    static bool parseCpuList(const string& text, vector<int>& cpus);
+
+    /** Restricts a thread to one CPU<br>
+     * @param thread Thread to pin
+     * @param cpu CPU number
+     * @return false if the kernel refused, e.g. for an offline CPU
+     */
+    static bool pin(pthread_t thread, int cpu);
+
+    /** Asks for a range's pages to be allocated on a node when first touched<br>
+     * Best effort: a kernel without NUMA support leaves the default policy.
+     * @param memory Page-aligned start of the range
+     * @param bytes Length of the range
+     * @param node Preferred node
+     */
+    static void preferNode(void* memory, size_t bytes, int node);
+};
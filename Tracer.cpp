@@ -0,0 +1,128 @@
+#include "Tracer.hpp"
+#include "Printer.hpp"
+#include <memory>
+#include <mutex>
+
+/** Registry state, touched only by attach, nameTrack and write */
+namespace {
+    mutex registryLock;
+    vector<unique_ptr<ThreadTrace>> registry;
+    vector<pair<int, string>> trackNames;
+    string outputPath;
+    bool on = false;
+    uint64_t startNs = 0;
+}
+
+/**
+ * Enables tracing<br>
+ * --------------------------------------------------
+ * - Timestamps in the file count from here.
+ * @param path Trace file path
+ */
+void Tracer::enable(const string& path) {
+    lock_guard<mutex> guard(registryLock);
+    outputPath = path;
+    on = true;
+    startNs = Metrics::now();
+}
+
+/** @return true once tracing is enabled */
+bool Tracer::enabled() {
+    lock_guard<mutex> guard(registryLock);
+    return on;
+}
+
+/** Attaches the calling thread */
+void Tracer::attach() {
+    lock_guard<mutex> guard(registryLock);
+    if (!on) return;
+    registry.push_back(make_unique<ThreadTrace>());
+    registry.back()->events.reserve(4096);
+    current = registry.back().get();
+}
+
+/**
+ * Names a track<br>
+ * --------------------------------------------------
+ * @param track Track id
+ * @param name Label shown on the timeline
+ */
+void Tracer::nameTrack(int track, const string& name) {
+    lock_guard<mutex> guard(registryLock);
+    if (on) trackNames.emplace_back(track, name);
+}
+
+/**
+ * Writes a timestamp<br>
+ * --------------------------------------------------
+ * - Chrome traces count in microseconds; three decimals keep the nanoseconds.
+ * @param out Trace file
+ * @param ns Nanoseconds since enable()
+ */
+static void writeMicros(ostream& out, uint64_t ns) {
+    out << ns / 1000 << '.' << setw(3) << setfill('0') << ns % 1000 << setfill(' ');
+}
+
+/**
+ * Writes the trace file<br>
+ * --------------------------------------------------
+ * - Chrome trace-event JSON: a process name, a name and sort index for every
+ *   track, then one complete ("X") event per slice with its slot and count as args.
+ * - Slices are written per thread buffer, unsorted; viewers order them by time.
+ * @return false if the file could not be written
+ */
+bool Tracer::write() {
+    lock_guard<mutex> guard(registryLock);
+    if (!on) return true;
+    ofstream out(outputPath, ios::out | ios::trunc);
+    out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n"
+        << "{\"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"name\": \"process_name\", \"args\": {\"name\": \"dispatcher\"}}";
+    for (const pair<int, string>& track : trackNames) {
+        out << ",\n{\"ph\": \"M\", \"pid\": 1, \"tid\": " << track.first << ", \"name\": \"thread_name\", \"args\": {\"name\": \""
+            << track.second << "\"}}"
+            << ",\n{\"ph\": \"M\", \"pid\": 1, \"tid\": " << track.first
+            << ", \"name\": \"thread_sort_index\", \"args\": {\"sort_index\": " << track.first << "}}";
+    }
+
+    uint64_t written = 0, dropped = 0;
+    for (const unique_ptr<ThreadTrace>& thread : registry) {
+        dropped += thread->dropped;
+        for (const TraceEvent& event : thread->events) {
+            uint64_t start = event.start > startNs ? event.start - startNs : 0;
+            uint64_t end = event.end > startNs ? event.end - startNs : 0;
+            out << ",\n{\"ph\": \"X\", \"pid\": 1, \"tid\": " << event.track
+                << ", \"name\": \"" << traceSpanName[static_cast<int>(event.span)] << "\", \"ts\": ";
+            writeMicros(out, start);
+            out << ", \"dur\": ";
+            writeMicros(out, end - min(start, end));
+            out << ", \"args\": {";
+            switch (event.span) {
+                case TraceSpan::CLAIM:
+                case TraceSpan::REFILL:
+                    out << "\"jobs\": " << event.count;
+                    break;
+                case TraceSpan::JOB:
+                    out << "\"slot\": " << event.job << ", \"value\": " << event.count;
+                    break;
+                case TraceSpan::ANNOUNCE:
+                    out << "\"slot\": " << event.job;
+                    break;
+                default:
+                    break;
+            }
+            out << "}}";
+            written++;
+        }
+    }
+    out << "\n]}\n";
+    out.close();
+    if (!out) {
+        cerr << "Cannot write trace file " << outputPath << endl;
+        return false;
+    }
+    ss << "Trace: " << written << " events on " << trackNames.size() << " tracks written to " << outputPath;
+    if (dropped > 0) ss << " (" << dropped << " dropped past " << maxEventsPerThread << " per thread)";
+    ss << endl;
+    Printer::write(ss, cout);
+    return true;
+}
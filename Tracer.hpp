@@ -0,0 +1,121 @@
+#pragma once
+#include "tools.hpp"
+#include "Metrics.hpp"
+
+/** Slices a trace holds, one name each on the timeline */
+enum class TraceSpan : uint8_t {
+    CLAIM, JOB, ANNOUNCE, IDLE, REFILL, COUNT
+    };
+
+const string traceSpanName[]={"claim", "job", "announce", "idle", "refill"};
+
+/**
+ * TraceEvent struct<br>
+ * ------------------------------------------------------<br>
+ * - One finished slice: what it was, whose track it belongs to and when it
+ *   began and ended, in Metrics::now() nanoseconds.<br>
+ */
+struct TraceEvent {
+    uint64_t start;    ///< When the slice began
+    uint64_t end;      ///< When it ended
+    int32_t track;     ///< Tracer::momTrack, or Tracer::kidTrack(kid id)
+    int32_t job;       ///< Table slot, or -1
+    int32_t count;     ///< Jobs claimed or refilled, or the job's value
+    TraceSpan span;    ///< Slice name
+};
+
+/**
+ * ThreadTrace struct<br>
+ * ------------------------------------------------------<br>
+ * - One thread's events, appended without a lock and read once the run is over.<br>
+ * - Owned by the Tracer registry.<br>
+ */
+struct ThreadTrace {
+    vector<TraceEvent> events;
+    uint64_t dropped = 0;      ///< Events past Tracer::maxEventsPerThread
+};
+
+/**
+ * Tracer class<br>
+ * ------------------------------------------------------<br>
+ * - Records claim, job, announce, idle and refill slices with nanosecond
+ *   timestamps and writes them as Chrome trace-event JSON, which Perfetto
+ *   and chrome://tracing open directly.<br>
+ * - Buffers are per thread, as in Metrics; events carry their track, so a
+ *   coroutine kid keeps its own track whichever worker thread runs it.<br>
+ * - Mom is track 0 and kid i is track i + 1, each named in the file.<br>
+ * - A thread records only after attach(); until then a call costs one
+ *   thread-local load.<br>
+ */
+class Tracer {
+private:
+    static inline thread_local ThreadTrace* current = nullptr;   ///< Calling thread's buffer
+
+public:
+    static constexpr size_t maxEventsPerThread = 1 << 20;  ///< Later events are counted, not kept
+    static constexpr int momTrack = 0;                      ///< Mom's track id
+
+    /** Returns a kid's track id */
+    static int kidTrack(int kid) { return kid + 1; }
+
+    /** Turns tracing on for the process<br>
+     * @param path Trace file written by write()
+     */
+    static void enable(const string& path);
+
+    /** True once enable() has been called */
+    static bool enabled();
+
+    /** Gives the calling thread its own buffer, if tracing is enabled */
+    static void attach();
+
+    /** Names a track in the written file<br>
+     * @param track Track id
+     * @param name Kid name, or "Mom"
+     */
+    static void nameTrack(int track, const string& name);
+
+    /** True if the calling thread records, so callers can skip reading the clock */
+    static bool recording() { return current != nullptr; }
+
+    /** Records a slice ending now<br>
+     * @param span Slice name
+     * @param start Value of Metrics::now() when it began
+     * @param track Track it is drawn on
+     * @param job Table slot, or -1
+     * @param count Jobs claimed or refilled, or the job's value
+     */
+    static void record(TraceSpan span, uint64_t start, int track, int job = -1, int count = 0) {
+        if (current == nullptr) return;
+        if (current->events.size() >= maxEventsPerThread) {
+            current->dropped++;
+            return;
+        }
+        current->events.push_back({start, Metrics::now(), track, job, count, span});
+    }
+
+    /** Writes every thread's events to the trace file and prints a one-line summary<br>
+     * Only call once the threads that attached have stopped recording.
+     * @return false if the file could not be written
+     */
+    static bool write();
+};
+
+/**
+ * ScopedTrace class<br>
+ * ------------------------------------------------------<br>
+ * - Records a slice from construction to destruction, like ScopedTimer.<br>
+ * - Reads the clock only when the thread is attached.<br>
+ */
+class ScopedTrace {
+private:
+    TraceSpan span;
+    int track;
+    int job;
+    uint64_t start;
+
+public:
+    ScopedTrace(TraceSpan span, int track, int job = -1)
+        : span(span), track(track), job(job), start(Tracer::recording() ? Metrics::now() : 0) {}
+    ~ScopedTrace() { if (start != 0) Tracer::record(span, start, track, job); }
+};
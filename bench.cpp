@@ -0,0 +1,714 @@
+// Benchmark suite: micro-benchmarks of the hot paths and end-to-end sweeps,
+// written as JSON or CSV so runs of two versions can be diffed.
+//
+//   ./benchsuite [--format json|csv] [--out FILE] [--only micro|macro]
+//                [--kids 1,4] [--tables 10,1000] [--mixes random,cooperative] [--modes shared,steal,scan,priority]
+//                [--seconds N] [--tick USEC] [--jobs N] [--seed N]
+//
+// Micro:  filter/*   mood filters (the old moodChecker expression, Job::suits, the registry, inlined policies)
+//         select/*   each selection path on the virtual clock, one cooperative kid and one kid per mood
+//         printer/*  Printer::write, sync and async
+//         job/*      Job construction: new/delete, pooled, pooled with bulk-rolled ratings
+//         task/*     building and running a 40-byte Task inline, a 64-byte one on the heap, and std::function
+//         dag/*      declaring and releasing dependencies on 100k+ job DAGs, wide (few deep layers)
+//                    and deep (narrow, thousands of layers); time per edge to build and to run
+// Macro:  run/*      real kid threads for --seconds per point; jobs/sec and claim latency
+//                    across every combination of kids, table size, mood mix and schedule
+//         tasks/*    real kid threads running empty tasks (--work 0); time per task is the dispatch overhead
+//         deps/*     the tasks/* runs with two predecessors per job (--deps 2)
+//         ledger/*   the tasks/* runs without a ledger, and with one at a 10 ms and a 0 ms commit window;
+//                    completions/sec with durability off and on
+//         procs/*    the shared schedule with kid threads, then with kids as worker processes on a
+//                    shared-memory table (--processes); jobs/sec of the two claim paths at --tick
+#include "tools.hpp"
+#include "Mom.hpp"
+#include "Printer.hpp"
+#include "Metrics.hpp"
+#include "JobPool.hpp"
+#include "Random.hpp"
+#include "SelectionPolicy.hpp"
+#include <chrono>
+#include <functional>
+#include <getopt.h>
+
+#ifndef DISPATCHER_METRICS
+#error "benchsuite reads claim latency from the metrics histograms; configure with -DDISPATCHER_METRICS=ON"
+#endif
+
+/** One measurement: a named benchmark, the point it ran at and what it reported */
+struct Result {
+    string kind;                          ///< "micro" or "macro"
+    string name;                          ///< Benchmark name, e.g. select/SCAN/mixed
+    vector<pair<string, string>> params;  ///< Point in the sweep, in a fixed order
+    vector<pair<string, double>> values;  ///< Reported numbers, unit in the key
+};
+
+/** Suite options, filled from the command line */
+struct BenchConfig {
+    bool json = true;
+    string out;
+    bool micro = true;
+    bool macro = true;
+    vector<int> kids = {1, 4};
+    vector<int> tables = {10, 1000};
+    vector<string> mixes = {"random", "cooperative"};
+    vector<SchedMode> modes = {SchedMode::SHARED, SchedMode::STEAL, SchedMode::SCAN, SchedMode::PRIORITY};
+    int seconds = 1;
+    long tick = 0;
+    size_t jobs = 1000000;
+    uint64_t seed = 1;
+};
+
+static const string usage =
+    "Usage: benchsuite [options]\n"
+    "  --format json|csv   output format (default json)\n"
+    "  --out FILE          write results to FILE instead of stdout\n"
+    "  --only micro|macro  run one half of the suite\n"
+    "  --kids LIST         kid counts swept by the macro runs (default 1,4)\n"
+    "  --tables LIST       table sizes swept by the macro runs (default 10,1000)\n"
+    "  --mixes LIST        mood mixes: random, or strategy names joined by + (default random,cooperative)\n"
+    "  --modes LIST        schedules swept by the macro runs (default shared,steal,scan,priority)\n"
+    "  --seconds N         length of each macro run (default 1)\n"
+    "  --tick USEC         microseconds per unit of slow in macro runs (default 0: no sleeping)\n"
+    "  --jobs N            jobs per micro-benchmark (default 1000000)\n"
+    "  --seed N            run seed (default 1)\n";
+
+/** Nanoseconds since an arbitrary start */
+static double nowNs() {
+    return chrono::duration<double, nano>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/** Splits a comma-separated list */
+static vector<string> splitList(const string& text, char separator = ',') {
+    vector<string> items;
+    stringstream list(text);
+    string item;
+    while (getline(list, item, separator)) {
+        if (!item.empty()) items.push_back(item);
+    }
+    if (items.empty()) fatal("Empty list: " + text + "\n" + usage);
+    return items;
+}
+
+/** Reads a positive whole number */
+static long parseNumber(const string& text, long low) {
+    char* end = nullptr;
+    long value = strtol(text.c_str(), &end, 10);
+    if (end == text.c_str() || *end != '\0' || value < low) fatal("Bad number: " + text + "\n" + usage);
+    return value;
+}
+
+/** Turns a mix name into the strategies dealt to kids; random is empty */
+static vector<int> mixStrategies(const string& mix) {
+    vector<int> moods;
+    if (caseInsensitiveEquals(mix, "random")) return moods;
+    for (const string& name : splitList(mix, '+')) {
+        int index = StrategyRegistry::find(name);
+        if (index < 0) fatal("Unknown strategy in mix: " + name + "\n" + usage);
+        moods.push_back(index);
+    }
+    return moods;
+}
+
+static BenchConfig parseBenchArgs(int argc, char* argv[]) {
+    BenchConfig config;
+    const option longOptions[] = {
+        {"format",  required_argument, nullptr, 'f'},
+        {"out",     required_argument, nullptr, 'o'},
+        {"only",    required_argument, nullptr, 'O'},
+        {"kids",    required_argument, nullptr, 'k'},
+        {"tables",  required_argument, nullptr, 't'},
+        {"mixes",   required_argument, nullptr, 'M'},
+        {"modes",   required_argument, nullptr, 's'},
+        {"seconds", required_argument, nullptr, 'd'},
+        {"tick",    required_argument, nullptr, 'u'},
+        {"jobs",    required_argument, nullptr, 'j'},
+        {"seed",    required_argument, nullptr, 'r'},
+        {"help",    no_argument,       nullptr, 'h'},
+        {nullptr,   0,                 nullptr, 0}
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "f:o:O:k:t:M:s:d:u:j:r:h", longOptions, nullptr)) != -1) {
+        switch (opt) {
+            case 'f':
+                if (!caseInsensitiveEquals(optarg, "json") && !caseInsensitiveEquals(optarg, "csv")) fatal(usage);
+                config.json = caseInsensitiveEquals(optarg, "json");
+                break;
+            case 'o':
+                config.out = optarg;
+                break;
+            case 'O':
+                if (!caseInsensitiveEquals(optarg, "micro") && !caseInsensitiveEquals(optarg, "macro")) fatal(usage);
+                config.micro = caseInsensitiveEquals(optarg, "micro");
+                config.macro = !config.micro;
+                break;
+            case 'k':
+                config.kids.clear();
+                for (const string& item : splitList(optarg)) config.kids.push_back(parseNumber(item, 1));
+                break;
+            case 't':
+                config.tables.clear();
+                for (const string& item : splitList(optarg)) config.tables.push_back(parseNumber(item, 1));
+                break;
+            case 'M':
+                config.mixes = splitList(optarg);
+                for (const string& mix : config.mixes) mixStrategies(mix);
+                break;
+            case 's':
+                config.modes.clear();
+                for (const string& item : splitList(optarg)) {
+                    int mode = -1;
+                    for (int m = 0; m < 4; m++) if (caseInsensitiveEquals(item, schedModeName[m])) mode = m;
+                    if (mode < 0) fatal("Unknown schedule: " + item + "\n" + usage);
+                    config.modes.push_back(static_cast<SchedMode>(mode));
+                }
+                break;
+            case 'd':
+                config.seconds = parseNumber(optarg, 1);
+                break;
+            case 'u':
+                config.tick = parseNumber(optarg, 0);
+                break;
+            case 'j':
+                config.jobs = parseNumber(optarg, 1);
+                break;
+            case 'r':
+                config.seed = strtoull(optarg, nullptr, 0);
+                break;
+            case 'h':
+                cerr << usage;
+                exit(0);
+            default:
+                fatal(usage);
+        }
+    }
+    return config;
+}
+
+// ---------------------------------------------------------------- micro: filters
+
+/** Mood read through a volatile so the runtime variants cannot be specialized */
+static volatile int opaqueMood;
+
+/** The original Kid::moodChecker: one expression over all five moods */
+static bool moodExpression(const Job& job, Mood mood) {
+    return (job.getHeavy() < 3 && mood == Mood::LAZY) ||
+           (job.getDirty() < 3 && mood == Mood::PRISSY) ||
+           (job.getSlow() < 3 && mood == Mood::OVERTIRED) ||
+           (job.getValue() > 40 && mood == Mood::GREEDY) ||
+           mood == Mood::COOPERATIVE;
+}
+
+/** Times a runtime filter over every job and mood<br>
+ * @return Nanoseconds per job and mood
+ */
+template <class Filter>
+static double timeFilter(const vector<const Job*>& jobs, Filter accepts, long& taken) {
+    double start = nowNs();
+    for (int m = 0; m < 5; m++) {
+        for (const Job* job : jobs) taken += accepts(*job, m);
+    }
+    return (nowNs() - start) / (double(jobs.size()) * 5);
+}
+
+/** Counts eligible jobs with a policy's inlined filter */
+template <SelectionPolicy P>
+static long countWith(const vector<const Job*>& jobs) {
+    long taken = 0;
+    for (const Job* job : jobs) taken += P::eligible(*job);
+    return taken;
+}
+
+static void benchFilters(const BenchConfig& config, vector<Result>& results) {
+    JobPool pool;
+    vector<const Job*> jobs;
+    jobs.reserve(config.jobs);
+    for (size_t i = 0; i < config.jobs; i++) jobs.push_back(pool.get(pool.acquire()));
+    opaqueMood = 0;
+
+    vector<pair<string, string>> params = {{"jobs", to_string(config.jobs)}};
+    long taken = 0;
+    results.push_back({"micro", "filter/moodChecker", params, {{"ns_per_job", timeFilter(jobs, [](const Job& job, int m) {
+        return moodExpression(job, static_cast<Mood>(opaqueMood + m));
+    }, taken)}}});
+    results.push_back({"micro", "filter/suits", params, {{"ns_per_job", timeFilter(jobs, [](const Job& job, int m) {
+        return job.suits(static_cast<Mood>(opaqueMood + m));
+    }, taken)}}});
+    results.push_back({"micro", "filter/registry", params, {{"ns_per_job", timeFilter(jobs, [](const Job& job, int m) {
+        return StrategyRegistry::get(opaqueMood + m).eligible(job);
+    }, taken)}}});
+
+    // Policy path: the mood is resolved once per pass, the loop body is the bare filter
+    double start = nowNs();
+    taken += countWith<LazyPolicy>(jobs) + countWith<PrissyPolicy>(jobs) + countWith<OvertiredPolicy>(jobs)
+           + countWith<CooperativePolicy>(jobs) + countWith<GreedyPolicy>(jobs);
+    double policy = (nowNs() - start) / (double(jobs.size()) * 5);
+    results.push_back({"micro", "filter/policy", params, {{"ns_per_job", policy}}});
+    if (taken == 0) cerr << "no job passed any filter" << endl;
+}
+
+// ---------------------------------------------------------------- micro: selection paths
+
+/** Runs each selection path on the virtual clock<br>
+ * Kids claim, simulated jobs finish and Mom refills, all on this thread, so time
+ * per job is the single-threaded cost of the dispatch path and the claim histogram
+ * isolates selection itself. Two mixes per schedule: one cooperative kid, which
+ * walks the table from the end, and one kid per built-in mood. A lone kid of a
+ * pickier mood would drain its eligible jobs and stall, so it is not run alone.
+ */
+static void benchSelection(const BenchConfig& config, vector<Result>& results) {
+    const vector<pair<string, vector<int>>> mixes = {
+        {"cooperative", {static_cast<int>(Mood::COOPERATIVE)}},
+        {"mixed", {0, 1, 2, 3, 4}},
+    };
+    for (int mode = 0; mode < 4; mode++) {
+        for (const auto& [mix, moods] : mixes) {
+            Config run;
+            run.schedule = static_cast<SchedMode>(mode);
+            run.clock = ClockMode::VIRTUAL;
+            run.kids = static_cast<int>(moods.size());
+            run.tableSize = 1000;
+            // A kid finishes a job every 3 simulated seconds on average
+            run.duration = static_cast<int>(min<size_t>(3 * config.jobs / moods.size() / 4, numeric_limits<int>::max()));
+            run.moods = moods;
+            run.seed = config.seed;
+
+            Metrics::reset();
+            double start = nowNs();
+            {
+                Mom mom(run);
+                mom.run();
+            }
+            double wall = nowNs() - start;
+            uint64_t jobs = Metrics::totalJobs();
+            auto claims = make_unique<Histogram>();
+            Metrics::merge(Metric::CLAIM, *claims);
+
+            results.push_back({"micro", "select/" + schedModeName[mode] + "/" + mix,
+                               {{"schedule", schedModeName[mode]}, {"mix", mix}, {"table", "1000"}},
+                               {{"jobs", double(jobs)}, {"ns_per_job", wall / max<uint64_t>(jobs, 1)},
+                                {"claim_p50_ns", double(claims->percentile(0.5))},
+                                {"claim_p99_ns", double(claims->percentile(0.99))}}});
+        }
+    }
+}
+
+// ---------------------------------------------------------------- micro: printer
+
+/** Times Printer::write of a typical job line, sync and async; cout is /dev/null here */
+static void benchPrinter(const BenchConfig& config, vector<Result>& results) {
+    size_t count = config.jobs / 4;
+    vector<pair<string, string>> params = {{"messages", to_string(count)}};
+    const string message = "Job ID:42 is completed by Cory\n";
+
+    double start = nowNs();
+    for (size_t i = 0; i < count; i++) Printer::write(message, cout);
+    results.push_back({"micro", "printer/sync", params, {{"ns_per_message", (nowNs() - start) / count}}});
+
+    Printer::startAsync();
+    start = nowNs();
+    for (size_t i = 0; i < count; i++) Printer::write(message, cout);
+    double enqueued = nowNs() - start;
+    Printer::stopAsync();
+    double drained = nowNs() - start;
+    results.push_back({"micro", "printer/async", params,
+                       {{"ns_per_message", enqueued / count}, {"ns_per_message_drained", drained / count}}});
+}
+
+// ---------------------------------------------------------------- micro: job construction
+
+/** Times building a job three ways: heap, pool with per-job rolls, pool with one bulk roll */
+static void benchJobs(const BenchConfig& config, vector<Result>& results) {
+    const size_t block = 1024;
+    size_t count = config.jobs / block * block;
+    vector<pair<string, string>> params = {{"jobs", to_string(count)}};
+    Rng::local() = Rng(config.seed, 0);
+
+    vector<Job*> heap(block);
+    double start = nowNs();
+    for (size_t done = 0; done < count; done += block) {
+        for (Job*& job : heap) job = new Job();
+        for (Job* job : heap) delete job;
+    }
+    results.push_back({"micro", "job/new", params, {{"ns_per_job", (nowNs() - start) / count}}});
+
+    JobPool pool;
+    vector<JobHandle> handles(block);
+    start = nowNs();
+    for (size_t done = 0; done < count; done += block) {
+        for (JobHandle& handle : handles) handle = pool.acquire();
+        for (JobHandle handle : handles) pool.release(handle);
+    }
+    results.push_back({"micro", "job/pool", params, {{"ns_per_job", (nowNs() - start) / count}}});
+
+    vector<uint8_t> ratings(3 * block);
+    start = nowNs();
+    for (size_t done = 0; done < count; done += block) {
+        Rng::local().fill(ratings.data(), ratings.size(), 1, 5);
+        for (size_t k = 0; k < block; k++) handles[k] = pool.acquire(ratings[3 * k], ratings[3 * k + 1], ratings[3 * k + 2]);
+        for (JobHandle handle : handles) pool.release(handle);
+    }
+    results.push_back({"micro", "job/pool-bulk", params, {{"ns_per_job", (nowNs() - start) / count}}});
+}
+
+// ---------------------------------------------------------------- micro: tasks
+
+/** Times building, running and destroying a task per job, like a job's life in the pool<br>
+ * @param make Returns the callable wrapper for the i-th job
+ * @return Nanoseconds per task
+ */
+template <class Make>
+static double timeTasks(size_t count, Make make, int64_t& sink) {
+    double start = nowNs();
+    for (size_t i = 0; i < count; i++) {
+        auto task = make(i);
+        sink += *task();
+    }
+    return (nowNs() - start) / count;
+}
+
+static void benchTasks(const BenchConfig& config, vector<Result>& results) {
+    vector<pair<string, string>> params = {{"tasks", to_string(config.jobs)}};
+    int64_t sink = 0;
+    struct Small { uint64_t words[5]; };   // 40 bytes: inline in a Task, heap in libstdc++'s std::function
+    struct Large { uint64_t words[8]; };   // 64 bytes: over Task::inlineSize
+
+    double inlined = timeTasks(config.jobs, [](size_t i) {
+        Small captured{{i, 1, 2, 3, 4}};
+        return Task([captured]() { return static_cast<int64_t>(captured.words[0] + captured.words[4]); });
+    }, sink);
+    results.push_back({"micro", "task/inline", params, {{"ns_per_task", inlined}}});
+
+    double heap = timeTasks(config.jobs, [](size_t i) {
+        Large captured{{i, 1, 2, 3, 4, 5, 6, 7}};
+        return Task([captured]() { return static_cast<int64_t>(captured.words[0] + captured.words[7]); });
+    }, sink);
+    results.push_back({"micro", "task/heap", params, {{"ns_per_task", heap}}});
+
+    double wrapped = timeTasks(config.jobs, [](size_t i) {
+        Small captured{{i, 1, 2, 3, 4}};
+        function<int64_t()> task = [captured]() { return static_cast<int64_t>(captured.words[0] + captured.words[4]); };
+        return [task = std::move(task)]() mutable { return optional<int64_t>(task()); };
+    }, sink);
+    results.push_back({"micro", "task/std-function", params, {{"ns_per_task", wrapped}}});
+    if (sink == 0) cerr << "tasks returned nothing" << endl;
+}
+
+// ---------------------------------------------------------------- micro: dependency DAGs
+
+/** Builds a layered DAG in the pool and runs it to completion on one thread<br>
+ * Each job waits for fanIn jobs of the layer above: the one in its own column and
+ * the next ones, wrapping around, so every job but the first layer's has fanIn edges.
+ * Running pops a ready job, releases its successors and queues the ones that became
+ * ready, which is what announceDone does minus the table lock.
+ * @param width Jobs per layer
+ * @param layers Number of layers
+ * @param fanIn Predecessors per job below the first layer
+ * @return Nanoseconds per edge to declare, and to release
+ */
+static pair<double, double> timeDag(int width, int layers, int fanIn, long& edges) {
+    JobPool pool;
+    vector<Job*> jobs;
+    jobs.reserve(size_t(width) * layers);
+    vector<Job*> ready;
+    vector<Job*> predecessors(fanIn);
+    edges = 0;
+
+    double start = nowNs();
+    for (int layer = 0; layer < layers; layer++) {
+        for (int column = 0; column < width; column++) {
+            Job* job = pool.get(pool.acquire(1, 1, 1));
+            size_t count = 0;
+            if (layer > 0) {
+                for (int k = 0; k < fanIn; k++) predecessors[count++] = jobs[size_t(layer - 1) * width + (column + k) % width];
+            }
+            if (job->waitFor(span<Job* const>(predecessors.data(), count))) ready.push_back(job);
+            edges += static_cast<long>(count);
+            jobs.push_back(job);
+        }
+    }
+    double built = nowNs() - start;
+
+    size_t done = 0;
+    start = nowNs();
+    while (!ready.empty()) {
+        Job* job = ready.back();
+        ready.pop_back();
+        done++;
+        job->releaseSuccessors([&ready](Job* next) { ready.push_back(next); });
+    }
+    double ran = nowNs() - start;
+    if (done != jobs.size()) cerr << "dag: ran " << done << " of " << jobs.size() << " jobs" << endl;
+    return {built / max(edges, 1L), ran / max(edges, 1L)};
+}
+
+static void benchDag(const BenchConfig& config, vector<Result>& results) {
+    int nodes = static_cast<int>(max<size_t>(100000, config.jobs / 4));
+    struct Shape { const char* name; int width; int fanIn; };
+    for (Shape shape : {Shape{"wide", nodes / 8, 4}, Shape{"deep", 16, 2}}) {
+        int layers = nodes / shape.width;
+        long edges;
+        pair<double, double> perEdge = timeDag(shape.width, layers, shape.fanIn, edges);
+        results.push_back({"micro", string("dag/") + shape.name,
+                           {{"jobs", to_string(size_t(shape.width) * layers)}, {"width", to_string(shape.width)},
+                            {"layers", to_string(layers)}, {"fan_in", to_string(shape.fanIn)}},
+                           {{"edges", double(edges)}, {"build_ns_per_edge", perEdge.first}, {"release_ns_per_edge", perEdge.second}}});
+    }
+}
+
+// ---------------------------------------------------------------- macro
+
+/** Runs real kid threads at every point of the sweep<br>
+ * Kids are token-controlled and quiet, so a run ends at a job boundary and
+ * its cost is claiming, announcing and refilling rather than printing.
+ */
+static void benchRuns(const BenchConfig& config, vector<Result>& results) {
+    for (int kids : config.kids) {
+        for (int table : config.tables) {
+            for (const string& mix : config.mixes) {
+                for (SchedMode mode : config.modes) {
+                    Config run;
+                    run.schedule = mode;
+                    run.kids = kids;
+                    run.tableSize = table;
+                    run.duration = config.seconds;
+                    run.tick = config.tick;
+                    run.moods = mixStrategies(mix);
+                    run.control = ControlMode::TOKEN;
+                    run.quiet = true;
+                    run.seed = config.seed;
+
+                    string name = schedModeName[static_cast<int>(mode)];
+                    cerr << "run/" << name << " kids=" << kids << " table=" << table << " mix=" << mix << endl;
+                    Metrics::reset();
+                    double start = nowNs();
+                    {
+                        Mom mom(run);
+                        mom.run();
+                    }
+                    double seconds = (nowNs() - start) / 1e9;
+                    uint64_t jobs = Metrics::totalJobs();
+                    auto claims = make_unique<Histogram>();
+                    Metrics::merge(Metric::CLAIM, *claims);
+
+                    results.push_back({"macro", "run/" + name,
+                                       {{"schedule", name}, {"kids", to_string(kids)}, {"table", to_string(table)},
+                                        {"mix", mix}, {"tick_us", to_string(config.tick)}},
+                                       {{"jobs", double(jobs)}, {"jobs_per_sec", jobs / seconds},
+                                        {"claim_p50_ns", double(claims->percentile(0.5))},
+                                        {"claim_p99_ns", double(claims->percentile(0.99))}}});
+                }
+            }
+        }
+    }
+}
+
+/** Runs real kids on empty tasks for every kid count and schedule<br>
+ * Every job carries a task that returns at once, so wall time per task is what
+ * claiming, running through the Task wrapper, announcing and refilling cost.
+ * The table is the largest swept size and every kid is cooperative, so no job is refused.
+ * With deps, every job also waits for that many earlier jobs; the difference to
+ * the plain runs is what declaring and releasing the edges costs under load.
+ * @param deps Predecessors per job, 0 for the plain tasks runs
+ */
+static void benchTaskRuns(const BenchConfig& config, vector<Result>& results, int deps) {
+    int table = *max_element(config.tables.begin(), config.tables.end());
+    string kind = deps > 0 ? "deps/" : "tasks/";
+    for (int kids : config.kids) {
+        for (SchedMode mode : config.modes) {
+            Config run;
+            run.schedule = mode;
+            run.kids = kids;
+            run.tableSize = table;
+            run.duration = config.seconds;
+            run.work = 0;
+            run.deps = deps;
+            run.moods = {static_cast<int>(Mood::COOPERATIVE)};
+            run.control = ControlMode::TOKEN;
+            run.quiet = true;
+            run.seed = config.seed;
+
+            string name = schedModeName[static_cast<int>(mode)];
+            cerr << kind << name << " kids=" << kids << " table=" << table << endl;
+            Metrics::reset();
+            double start = nowNs();
+            {
+                Mom mom(run);
+                mom.run();
+            }
+            double wall = nowNs() - start;
+            uint64_t jobs = Metrics::totalJobs();
+            results.push_back({"macro", kind + name,
+                               {{"schedule", name}, {"kids", to_string(kids)}, {"table", to_string(table)}},
+                               {{"tasks", double(jobs)}, {"tasks_per_sec", jobs / (wall / 1e9)},
+                                {"ns_per_task", wall / max<uint64_t>(jobs, 1)}}});
+        }
+    }
+}
+
+/** Runs real kids on empty tasks with and without the completion ledger<br>
+ * off has no ledger; on/10ms and on/0ms append every completion to a fresh
+ * ledger in a temporary directory, group-committed per 10 ms window or per
+ * batch. Snapshots are only taken at the start and end, so the difference is
+ * what appending and syncing cost Mom's refill loop.
+ */
+static void benchLedger(const BenchConfig& config, vector<Result>& results) {
+    int table = *max_element(config.tables.begin(), config.tables.end());
+    struct Variant { const char* name; int commitMillis; };
+    const Variant variants[] = {{"off", -1}, {"on/10ms", 10}, {"on/0ms", 0}};
+    for (int kids : config.kids) {
+        for (SchedMode mode : config.modes) {
+            for (const Variant& variant : variants) {
+                Config run;
+                run.schedule = mode;
+                run.kids = kids;
+                run.tableSize = table;
+                run.duration = config.seconds;
+                run.work = 0;
+                run.moods = {static_cast<int>(Mood::COOPERATIVE)};
+                run.control = ControlMode::TOKEN;
+                run.quiet = true;
+                run.seed = config.seed;
+                char dir[] = "/tmp/benchledgerXXXXXX";
+                if (variant.commitMillis >= 0) {
+                    if (mkdtemp(dir) == nullptr) fatal("Cannot create a ledger directory in /tmp");
+                    run.ledgerDir = dir;
+                    run.commitMillis = variant.commitMillis;
+                    run.snapshotEvery = 0;
+                }
+
+                string name = schedModeName[static_cast<int>(mode)];
+                cerr << "ledger/" << variant.name << " " << name << " kids=" << kids << " table=" << table << endl;
+                Metrics::reset();
+                double start = nowNs();
+                {
+                    Mom mom(run);
+                    mom.run();
+                }
+                double wall = nowNs() - start;
+                uint64_t jobs = Metrics::totalJobs();
+                if (!run.ledgerDir.empty()) {
+                    unlink((run.ledgerDir + "/ledger.bin").c_str());
+                    unlink((run.ledgerDir + "/snapshot.bin").c_str());
+                    rmdir(run.ledgerDir.c_str());
+                }
+                results.push_back({"macro", "ledger/" + string(variant.name) + "/" + name,
+                                   {{"schedule", name}, {"kids", to_string(kids)}, {"table", to_string(table)}},
+                                   {{"completions", double(jobs)}, {"completions_per_sec", jobs / (wall / 1e9)}}});
+            }
+        }
+    }
+}
+
+/** Runs the shared schedule with kid threads and with worker processes<br>
+ * Every kid is cooperative and the table is the largest swept size. Workers
+ * report no metrics of their own, so jobs are the completions Mom collected,
+ * which is what the threaded runs count too.
+ */
+static void benchProcesses(const BenchConfig& config, vector<Result>& results) {
+    int table = *max_element(config.tables.begin(), config.tables.end());
+    for (int kids : config.kids) {
+        for (bool processes : {false, true}) {
+            Config run;
+            run.kids = kids;
+            run.tableSize = table;
+            run.duration = config.seconds;
+            run.tick = config.tick;
+            run.moods = {static_cast<int>(Mood::COOPERATIVE)};
+            run.control = ControlMode::TOKEN;
+            run.processes = processes;
+            run.quiet = true;
+            run.seed = config.seed;
+
+            string name = processes ? "processes" : "threads";
+            cerr << "procs/" << name << " kids=" << kids << " table=" << table << endl;
+            Metrics::reset();
+            double start = nowNs();
+            {
+                Mom mom(run);
+                mom.run();
+            }
+            double seconds = (nowNs() - start) / 1e9;
+            uint64_t jobs = Metrics::totalJobs();
+            results.push_back({"macro", "procs/" + name,
+                               {{"schedule", "SHARED"}, {"kids", to_string(kids)}, {"table", to_string(table)},
+                                {"tick_us", to_string(config.tick)}},
+                               {{"jobs", double(jobs)}, {"jobs_per_sec", jobs / seconds}}});
+        }
+    }
+}
+
+// ---------------------------------------------------------------- output
+
+static void writeJson(const vector<Result>& results, const BenchConfig& config, ostream& out) {
+    out << fixed << setprecision(3) << "{\"seed\": " << config.seed << ", \"results\": [\n";
+    for (size_t r = 0; r < results.size(); r++) {
+        const Result& result = results[r];
+        out << "  {\"kind\": \"" << result.kind << "\", \"name\": \"" << result.name << "\", \"params\": {";
+        for (size_t p = 0; p < result.params.size(); p++) {
+            out << (p ? ", " : "") << "\"" << result.params[p].first << "\": \"" << result.params[p].second << "\"";
+        }
+        out << "}";
+        for (const pair<string, double>& value : result.values) out << ", \"" << value.first << "\": " << value.second;
+        out << "}" << (r + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]}\n";
+}
+
+/** One row per reported number, so a diff lines up metric by metric */
+static void writeCsv(const vector<Result>& results, ostream& out) {
+    out << fixed << setprecision(3) << "kind,name,params,metric,value\n";
+    for (const Result& result : results) {
+        string params;
+        for (const pair<string, string>& param : result.params) {
+            params += (params.empty() ? "" : ";") + param.first + "=" + param.second;
+        }
+        for (const pair<string, double>& value : result.values) {
+            out << result.kind << "," << result.name << "," << params << "," << value.first << "," << value.second << "\n";
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config = parseBenchArgs(argc, argv);
+
+    // The dispatcher's own text goes nowhere; results keep the real stdout
+    ofstream devNull("/dev/null");
+    streambuf* stdoutBuffer = cout.rdbuf(devNull.rdbuf());
+    Printer::getControl(ofstream("/dev/null"));
+    Metrics::enable("");
+
+    vector<Result> results;
+    if (config.micro) {
+        cerr << "micro: filters" << endl;
+        benchFilters(config, results);
+        cerr << "micro: selection paths" << endl;
+        benchSelection(config, results);
+        cerr << "micro: printer" << endl;
+        benchPrinter(config, results);
+        cerr << "micro: job construction" << endl;
+        benchJobs(config, results);
+        cerr << "micro: tasks" << endl;
+        benchTasks(config, results);
+        cerr << "micro: dependency DAGs" << endl;
+        benchDag(config, results);
+    }
+    if (config.macro) {
+        benchRuns(config, results);
+        benchTaskRuns(config, results, 0);
+        benchTaskRuns(config, results, 2);
+        benchLedger(config, results);
+        benchProcesses(config, results);
+    }
+
+    cout.rdbuf(stdoutBuffer);
+    ofstream file;
+    if (!config.out.empty()) {
+        file.open(config.out);
+        if (!file) fatal("Cannot write " + config.out);
+    }
+    ostream& out = config.out.empty() ? cout : file;
+    if (config.json) writeJson(results, config, out);
+    else writeCsv(results, out);
+    return 0;
+}
@@ -0,0 +1,161 @@
+#include "tools.hpp"
+#include "EventLog.hpp"
+#include "Kid.hpp"
+#include "JobSource.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <strings.h>
+
+/** Usage text printed on -h or a bad option */
+static const string usage =
+    "Usage: eventdump [options] FILE\n"
+    "  -k, --kid ID|NAME   only events of this kid (by id or generated name)\n"
+    "  -j, --job N         only events of this job number\n"
+    "  -t, --times         prefix each event with seconds since the log was opened\n"
+    "  -J, --jobs OUT      write the jobs Mom posted, in order, to OUT as a job file for\n"
+    "                      untitled --input, instead of printing\n"
+    "  -h, --help          show this message\n";
+
+/**
+ * Writes one record as the text the dispatcher prints in sync mode<br>
+ * --------------------------------------------------
+ * @param out Destination stream
+ * @param record Event to format
+ */
+static void printEvent(ostream& out, const EventRecord& record) {
+    string name = record.kid == EventLog::momId ? "Mom" : Kid::makeName(record.kid);
+    switch (record.type) {
+        case EventType::JOB_POSTED:
+            out << "Job" << record.job << '\n'
+                << "The job value is : " << record.value
+                << " it has " << int(record.slow) << " slow"
+                << " it has " << int(record.dirty) << " dirty"
+                << " it has " << int(record.heavy) << " heavy" << "\n\n";
+            break;
+        case EventType::JOB_REFILLED:
+            out << "Adding new job at index: " << record.job << '\n';
+            break;
+        case EventType::JOB_CLAIMED:
+            out << name << " claimed Job ID:" << record.job << '\n';
+            break;
+        case EventType::JOB_DONE:
+            out << "Job ID:" << record.job << " is completed" << '\n'
+                << "Job Completed status: " << jobStatusName[static_cast<int>(JobStatus::COMPLETE)] << '\n';
+            break;
+        case EventType::KID_START:
+            out << "Start working: " << name << '\n'
+                << name << " mood is: " << moodName[record.mood] << '\n';
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * Main Function <br>
+ * ------------------------------------------------------- <br>
+ * - Maps a binary event log read-only and prints it as text <br>
+ * - Records are visited in file order; nothing is loaded up front <br>
+ * - Optional filters keep only one kid's or one job's events <br>
+ * - With --jobs, the JOB_POSTED and JOB_REFILLED ratings become a job file instead <br>
+ */
+int main(int argc, char* argv[]) {
+    int kidFilter = -1;
+    long jobFilter = -1;
+    bool times = false;
+    string jobsOut;
+    const option longOptions[] = {
+        {"kid",   required_argument, nullptr, 'k'},
+        {"job",   required_argument, nullptr, 'j'},
+        {"times", no_argument,       nullptr, 't'},
+        {"jobs",  required_argument, nullptr, 'J'},
+        {"help",  no_argument,       nullptr, 'h'},
+        {nullptr, 0,                 nullptr, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "k:j:tJ:h", longOptions, nullptr)) != -1) {
+        switch (opt) {
+            case 'k':
+                if (isdigit(static_cast<unsigned char>(optarg[0]))) kidFilter = atoi(optarg);
+                else for (int id = 0; id < EventLog::momId && kidFilter < 0; id++) {
+                    if (strcasecmp(optarg, Kid::makeName(id).c_str()) == 0) kidFilter = id;
+                }
+                if (kidFilter < 0) { cerr << "Unknown kid: " << optarg << '\n' << usage; return 1; }
+                break;
+            case 'j':
+                jobFilter = atol(optarg);
+                break;
+            case 't':
+                times = true;
+                break;
+            case 'J':
+                jobsOut = optarg;
+                break;
+            case 'h':
+                cout << usage;
+                return 0;
+            default:
+                cerr << usage;
+                return 1;
+        }
+    }
+    if (optind != argc - 1) { cerr << usage; return 1; }
+
+    int fd = open(argv[optind], O_RDONLY);
+    struct stat info{};
+    if (fd < 0 || fstat(fd, &info) != 0 || size_t(info.st_size) < EventLog::headerBytes) {
+        cerr << "Cannot read event log " << argv[optind] << '\n';
+        return 1;
+    }
+    void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) { perror("mmap"); return 1; }
+    madvise(mapped, info.st_size, MADV_SEQUENTIAL);
+
+    const auto* header = static_cast<const EventLogHeader*>(mapped);
+    if (memcmp(header->magic, "TDEVLOG1", 8) != 0 || header->recordSize != sizeof(EventRecord)) {
+        cerr << argv[optind] << " is not a version 1 event log\n";
+        return 1;
+    }
+
+    // A log that was never closed has count 0; read whatever the file holds
+    uint64_t available = (info.st_size - EventLog::headerBytes) / sizeof(EventRecord);
+    uint64_t count = header->count != 0 ? min(header->count, available) : available;
+    const auto* records = reinterpret_cast<const EventRecord*>(static_cast<const char*>(mapped) + EventLog::headerBytes);
+
+    if (!jobsOut.empty()) {
+        ofstream out(jobsOut, ios::binary | ios::trunc);
+        JobFileHeader jobHeader{{'T', 'D', 'J', 'O', 'B', 'S', '0', '1'}, 1, sizeof(JobFileRecord)};
+        out.write(reinterpret_cast<const char*>(&jobHeader), sizeof(jobHeader));
+        uint64_t jobs = 0;
+        for (uint64_t i = 0; i < count; i++) {
+            const EventRecord& record = records[i];
+            if (record.type != EventType::JOB_POSTED && record.type != EventType::JOB_REFILLED) continue;
+            JobFileRecord job{record.slow, record.dirty, record.heavy, 0};
+            out.write(reinterpret_cast<const char*>(&job), sizeof(job));
+            jobs++;
+        }
+        if (!out) { cerr << "Cannot write " << jobsOut << '\n'; return 1; }
+        cerr << jobs << " jobs written to " << jobsOut << '\n';
+        munmap(mapped, info.st_size);
+        close(fd);
+        return 0;
+    }
+
+    cout << fixed << setprecision(6);
+    for (uint64_t i = 0; i < count; i++) {
+        const EventRecord& record = records[i];
+        if (record.type == EventType::NONE) continue;
+        if (kidFilter >= 0 && record.kid != kidFilter) continue;
+        if (jobFilter >= 0 && record.job != jobFilter) continue;
+        if (times) {
+            double seconds = double(record.ticks - header->startTicks) / header->ticksPerNs / 1e9;
+            cout << '[' << setw(12) << seconds << " s] ";
+        }
+        printEvent(cout, record);
+    }
+
+    munmap(mapped, info.st_size);
+    close(fd);
+    return 0;
+}
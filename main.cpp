@@ -1,19 +1,37 @@
 #include "tools.hpp"
 #include "Mom.hpp"
+#include "Printer.hpp"
+#include "EventLog.hpp"
+#include "Metrics.hpp"
+#include "Tracer.hpp"
 
 /**
  * Main Function <br>
  * ------------------------------------------------------- <br>
- * - Initializes random seed using current time <br>
+ * - Parses startup options (e.g. --schedule shared|steal) <br>
+ * - Starts the Printer's flusher thread when --log async is given <br>
+ * - Opens the binary event log when --log binary is given <br>
+ * - Turns on metrics recording when --metrics is given <br>
+ * - Turns on tracing when --trace is given, and writes the trace after the run <br>
  * - Creates a `Mom` object <br>
  * - Runs the simulation using `Mom::run()` <br>
+ * - Drains and stops async logging and closes the event log <br>
  * - Exits program with return code 0 <br>
  */
-int main() {
-    srand(time(nullptr));
+int main(int argc, char* argv[]) {
+    Config config = parseArgs(argc, argv);
+    if (config.log == LogMode::ASYNC) Printer::startAsync();
+    if (config.log == LogMode::BINARY && !EventLog::open(config.eventFile)) {
+        fatal("Cannot create event log " + config.eventFile);
+    }
+    if (!config.metricsPrefix.empty()) Metrics::enable(config.metricsPrefix);
+    if (!config.traceFile.empty()) Tracer::enable(config.traceFile);
     // banner();  // Optional banner display
-    Mom mom;
+    Mom mom(config);
     mom.run();
+    Tracer::write();
+    Printer::stopAsync();
+    EventLog::close();
     // bye();     // Optional closing message
     return 0;
 }
@@ -155,3 +155,13 @@ bool caseInsensitiveEquals(const string& str1, const string& str2) {
     transform(lowerStr2.begin(), lowerStr2.end(), lowerStr2.begin(), ::tolower);
     return lowerStr1 == lowerStr2;
 }
+
+
+// ----------------------------------------------------------------------------
+//Resident memory of the process, from /proc/self/statm (Linux)
+size_t residentBytes() {
+    ifstream statm("/proc/self/statm");
+    size_t total = 0, resident = 0;
+    if (!(statm >> total >> resident)) return 0;
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
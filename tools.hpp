@@ -18,6 +18,9 @@
 #include <cmath>
 #include <ctime>
 #include <cctype>      // for isspace() and isdigit()
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
 #include <span>
 
 //Our Tools
@@ -73,6 +76,7 @@ int  menu( const char* title, int n, const string menu[] );
 //Murtaza & Yash Tools
 //----------------------------------------------------------------------
 bool caseInsensitiveEquals(const string& str1, const string& str2);
+size_t residentBytes();   // resident set size of the process, 0 if unknown
 
-//Global variable
-inline stringstream ss;
\ No newline at end of file
+//Global variable, one formatting buffer per thread
+inline thread_local stringstream ss;
\ No newline at end of file